@@ -1,5 +1,9 @@
 #include <sstream>
+#include <cmath>
 #include <math.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include <Rcpp.h>
 using namespace Rcpp;
@@ -7,6 +11,9 @@ using namespace Rcpp;
 // [[Rcpp::depends(RcppProgress)]]
 #include <progress.hpp>
 
+// include path is set by .onLoad()
+#include <eyelinkReader/signal_filters.h>
+
 namespace edfapi {
 #include "edf.h"
 }
@@ -89,6 +96,7 @@ typedef struct TRIAL_RECORDINGS{
 
 typedef struct TRAIL_SAMPLES{
   std::vector <unsigned int> trial_index;
+  std::vector <unsigned int> block_index;
   std::vector <edfapi::UINT32> time;
   std::vector <edfapi::UINT32> time_rel;
   std::vector <unsigned int> eye;
@@ -152,6 +160,58 @@ typedef struct TRAIL_SAMPLES{
 } TRIAL_SAMPLES;
 
 
+// streaming (Welford) accumulator for mean, variance, and range
+typedef struct RUNNING_STATS{
+  unsigned int n;
+  double mean;
+  double m2;
+  double min;
+  double max;
+} RUNNING_STATS;
+
+// per-eye accumulators for a single trial, see accumulate_sample and accumulate_event
+typedef struct EYE_ACCUMULATOR{
+  unsigned int samples;
+  unsigned int missing_samples;
+  unsigned int blinks;
+  unsigned int saccades;
+  float peak_velocity;
+  RUNNING_STATS pupil;
+  RUNNING_STATS gx;
+  RUNNING_STATS gy;
+} EYE_ACCUMULATOR;
+
+// per-trial and per-eye aggregates, one row per trial x eye
+typedef struct TRIAL_SUMMARY{
+  std::vector <unsigned int> trial_index;
+  std::vector <unsigned int> eye;
+  std::vector <unsigned int> samples;
+  std::vector <unsigned int> missing_samples;
+  std::vector <double> data_loss;
+  std::vector <unsigned int> blinks;
+  std::vector <unsigned int> saccades;
+  std::vector <double> peak_velocity;
+  std::vector <double> pupil_mean;
+  std::vector <double> pupil_sd;
+  std::vector <double> pupil_min;
+  std::vector <double> pupil_max;
+  std::vector <double> gx_mean;
+  std::vector <double> gx_sd;
+  std::vector <double> gy_mean;
+  std::vector <double> gy_sd;
+} TRIAL_SUMMARY;
+
+// per-trial data quality counters, see scan_trial_quality
+typedef struct TRIAL_QUALITY{
+  std::vector <double> samples;
+  std::vector <double> lost_data;
+  std::vector <double> sample_rate_changes;
+  std::vector <double> last_sample_rate;
+  std::vector <double> gaps;
+  std::vector <double> longest_gap;
+} TRIAL_QUALITY;
+
+
 //' @title Converts a float value to an explicit NaN, if necessary
 //' @param value float
 //' @return float
@@ -164,6 +224,27 @@ inline float float_or_nan(float value) {
 
 // ------------------ EDF API interface ------------------
 
+// The EDF API is not thread-safe, so it is used by a single call at a time. A background import holds it
+// from preparation till its worker thread closes the file. Other calls fail instead of blocking the R session.
+static std::atomic <bool> edf_api_in_use(false);
+
+//' @title Acquires the EDF API for exclusive use
+//' @description Throws an R error, if it is used by a background import. Must be called from the main thread
+//' and released via release_edf_api before any other R error is thrown.
+//' @keywords internal
+void acquire_edf_api(){
+  bool expected = false;
+  if (!edf_api_in_use.compare_exchange_strong(expected, true)){
+    ::Rf_error("EDF files cannot be read while a background import is running. Please collect or cancel it first.");
+  }
+}
+
+//' @title Releases the EDF API
+//' @keywords internal
+void release_edf_api(){
+  edf_api_in_use = false;
+}
+
 //' @title Version of the EDF API library
 //' @description Returns version of the EDF API library used to interface an EDF file.
 //' @export
@@ -172,13 +253,16 @@ inline float float_or_nan(float value) {
 //[[Rcpp::export]]
 CharacterVector library_version(){
   Rcpp::StringVector version_info(1);
+  acquire_edf_api();
   version_info[0] = edfapi::edf_get_version();
+  release_edf_api();
   return version_info;
 }
 
 
 // @title Opens EDF file, throws exception on error
 // @description Opens EDF file for reading, throws exception and prints error message if fails.
+// The EDF API must be acquired via acquire_edf_api, it is released on error.
 // @param std::string filename, name of the EDF file
 // @param int consistency, consistency check control (for the time stamps of the start
 // and end events, etc). 0, no consistency check. 1, check consistency and report.
@@ -194,6 +278,7 @@ edfapi::EDFFILE* safely_open_edf_file(std::string filename, int consistency, int
 
   // throwing an exception, if things go pear shaped
   if (ReturnValue != 0){
+    release_edf_api();
     std::stringstream error_message_stream;
     error_message_stream << "Error opening file '" << filename << "', error code: " << ReturnValue;
     ::Rf_error("%s", error_message_stream.str().c_str());
@@ -215,6 +300,7 @@ edfapi::EDFFILE* safely_open_edf_file(std::string filename, int consistency, int
 //' }
 //[[Rcpp::export]]
 std::string read_preamble_str(std::string filename){
+  acquire_edf_api();
   edfapi::EDFFILE* edfFile = safely_open_edf_file(filename, 2, 0, 0);
 
   // getting preable
@@ -223,6 +309,8 @@ std::string read_preamble_str(std::string filename){
   ReturnValue = edfapi::edf_get_preamble_text(edfFile, preamble_buffer, 2048);
   if (ReturnValue != 0)
   {
+    edfapi::edf_close_file(edfFile);
+    release_edf_api();
     std::stringstream error_message_stream;
     error_message_stream << "Error reading preable for file '" << filename << "', error code: " << ReturnValue;
     ::Rf_error("%s", error_message_stream.str().c_str());
@@ -231,6 +319,7 @@ std::string read_preamble_str(std::string filename){
 
   // closing file
   edfapi::edf_close_file(edfFile);
+  release_edf_api();
 
   return preamble;
 }
@@ -241,9 +330,10 @@ std::string read_preamble_str(std::string filename){
 //' @param EDFFILE* edfFile, pointer to the EDF file
 //' @param std::string start_marker_string, event that marks trial start. Defaults to "TRIALID", if empty.
 //' @param std::string end_marker_string, event that marks trial end
+//' @return bool, whether navigation was set up. Does not use R API, so that it can be called from a worker thread.
 //' @seealso safely_open_edf_file
 //' @keywords internal
-void set_trial_navigation_up(edfapi::EDFFILE* edfFile, std::string start_marker_string, std::string end_marker_string){
+bool set_trial_navigation_up(edfapi::EDFFILE* edfFile, std::string start_marker_string, std::string end_marker_string){
   // converting strings to char buffers
   char * start_marker_char = new char[start_marker_string.size() + 1];
   std::copy(start_marker_string.begin(), start_marker_string.end(), start_marker_char);
@@ -254,27 +344,23 @@ void set_trial_navigation_up(edfapi::EDFFILE* edfFile, std::string start_marker_
   end_marker_char[end_marker_string.size()] = '\0';
 
   // setting the trial identifier
-  if (edf_set_trial_identifier(edfFile, start_marker_char, end_marker_char)){
-    ::Rf_error("Error while setting up trial navigation identifier");
-  }
+  const bool ok = edf_set_trial_identifier(edfFile, start_marker_char, end_marker_char) == 0;
 
   // cleaning up
   delete[] start_marker_char;
   delete[] end_marker_char;
+  return ok;
 }
 
 //' @title Jumps to the i-th trial
-//' @description Jumps to the i-th trial, throws an exception and prints an error message, if fails.
+//' @description Jumps to the i-th trial.
 //' @param EDFFILE* edfFile, pointer to the EDF file
 //' @param int iTrial, index of the desired trial
+//' @return bool, whether the jump succeeded
 //' @seealso safely_open_edf_file, set_trial_navigation_up
 //' @keywords internal
-void jump_to_trial(edfapi::EDFFILE* edfFile, int iTrial){
-  if (edfapi::edf_jump_to_trial(edfFile, iTrial) != 0){
-    std::stringstream error_message_stream;
-    error_message_stream << "Error jumping to trial " << iTrial+1;
-    ::Rf_error("%s", error_message_stream.str().c_str());
-  }
+bool jump_to_trial(edfapi::EDFFILE* edfFile, int iTrial){
+  return edfapi::edf_jump_to_trial(edfFile, iTrial) == 0;
 }
 
 //' @title Prepare matrix for trial headers
@@ -303,22 +389,30 @@ NumericMatrix prepare_trial_headers(int total_trials){
   return (trial_headers);
 }
 
+// trial headers (same layout as prepare_trial_headers) that are filled without R API
+typedef struct TRIAL_HEADERS {
+  unsigned int rows;
+  std::vector <double> values;
+
+  double& operator()(unsigned int iTrial, int iColumn){
+    return values[iColumn * rows + iTrial];
+  }
+} TRIAL_HEADERS;
+
 //' @title Read header for the i-th trial
 //' @description Read head and store it in the i-th row of the headers matrix
 //' @param EDFFILE* edfFile, pointer to the EDF file
-//' @param NumericMatrix &trial_headers, reference to the trial header matrix
+//' @param TRIAL_HEADERS &trial_headers, reference to the trial headers
 //' @param int iTrial, the row in which the header will be stored.
 //' Functions assumes that the correct trial within the EDF file was already navigated to.
-//' @return modifes trial_headers i-th row in place
+//' @return bool, whether the header was obtained. Modifes trial_headers i-th row in place.
 //' @keywords internal
-void read_trial_header(edfapi::EDFFILE* edfFile, NumericMatrix &trial_headers, int iTrial){
+bool read_trial_header(edfapi::EDFFILE* edfFile, TRIAL_HEADERS &trial_headers, int iTrial){
 
   // obtaining the trial header
   edfapi::TRIAL current_header;
   if (edf_get_trial_header(edfFile, &current_header) != 0){
-    std::stringstream error_message_stream;
-    error_message_stream << "Error obtaining the header for the trial " << iTrial+1;
-    ::Rf_error("%s", error_message_stream.str().c_str());
+    return false;
   }
 
   // copying it over
@@ -337,6 +431,27 @@ void read_trial_header(edfapi::EDFFILE* edfFile, NumericMatrix &trial_headers, i
   trial_headers(iTrial,12) = current_header.rec->filter_type;
   trial_headers(iTrial,13) = current_header.rec->pos_type;
   trial_headers(iTrial,14) = current_header.rec->eye;
+  return true;
+}
+
+//' @title Finds trial that contains the timestamp
+//' @description Binary search over trial start times, trials must be sorted by their start.
+//' @param TRIAL_HEADERS &trial_headers, reference to the trial headers
+//' @param UINT32 timestamp
+//' @param UINT32 &trial_start, start of the trial, unchanged if there is none
+//' @return unsigned int, trial number (1-based) or 0, if the timestamp is outside of all trials.
+//' @keywords internal
+unsigned int locate_trial(TRIAL_HEADERS &trial_headers, edfapi::UINT32 timestamp, edfapi::UINT32 &trial_start){
+  unsigned int first = 0;
+  unsigned int last = trial_headers.rows;
+  while (first < last){
+    const unsigned int middle = first + (last - first) / 2;
+    if (trial_headers(middle, 2) <= timestamp) first = middle + 1;
+    else last = middle;
+  }
+  if (first == 0 || timestamp > trial_headers(first - 1, 3)) return 0;
+  trial_start = trial_headers(first - 1, 2);
+  return first;
 }
 
 //' @title Appends event to the even structure
@@ -438,10 +553,10 @@ void append_recording(TRIAL_RECORDINGS &recordings, edfapi::RECORDINGS new_rec,
 //' @param FSAMPLE new_sample, structure with sample info, as described in the EDF API manual
 //' @param int iTrial, the index of the trial the event belongs to
 //' @param UINT32 trial_start, the timestamp of the trial start. Is used to compute event time relative to it.
-//' @param LogicalVector sample_attr_flag, boolean vector that indicates which sample fields are to be stored
+//' @param std::vector <bool> &sample_attr_flag, boolean vector that indicates which sample fields are to be stored
 //' @return modifies samples structure
 //' @keywords internal
-void append_sample(TRIAL_SAMPLES &samples, edfapi::FSAMPLE new_sample, unsigned int iTrial, edfapi::UINT32 trial_start, LogicalVector sample_attr_flag)
+void append_sample(TRIAL_SAMPLES &samples, edfapi::FSAMPLE new_sample, unsigned int iTrial, edfapi::UINT32 trial_start, const std::vector <bool> &sample_attr_flag)
 {
   samples.trial_index.push_back(iTrial+1);
 
@@ -571,114 +686,699 @@ void append_sample(TRIAL_SAMPLES &samples, edfapi::FSAMPLE new_sample, unsigned
 }
 
 
-// Internal function that reads EDF file
-//
-//' @title Internal function that reads EDF file
-//' @description Reads EDF file into a list that contains events, samples, and recordings.
-//' DO NOT call this function directly. Instead, use read_edf function that implements
-//' parameter checks and additional postprocessing.
+// ------------------ spilling samples to disk ------------------
+
+//' @title Calls visitor for every sample column in the order of the samples table
+//' @param TRIAL_SAMPLES &samples, reference to the trial samples structure
+//' @param VISITOR &visitor, functor called with column name, values, whether they are stored
+//' as double (otherwise as integer), and an offset added to integer codes
+//' @keywords internal
+template <typename VISITOR> void visit_sample_columns(TRIAL_SAMPLES &samples, VISITOR &visitor){
+  visitor("trial", samples.trial_index, true, 0);
+  visitor("block", samples.block_index, true, 0); // only for import by recording blocks
+  visitor("eye", samples.eye, false, 1); // factor codes
+  visitor("time", samples.time, true, 0);
+  visitor("time_rel", samples.time_rel, true, 0);
+  visitor("pxL", samples.pxL, true, 0);
+  visitor("pxR", samples.pxR, true, 0);
+  visitor("pyL", samples.pyL, true, 0);
+  visitor("pyR", samples.pyR, true, 0);
+  visitor("hxL", samples.hxL, true, 0);
+  visitor("hxR", samples.hxR, true, 0);
+  visitor("hyL", samples.hyL, true, 0);
+  visitor("hyR", samples.hyR, true, 0);
+  visitor("paL", samples.paL, true, 0);
+  visitor("paR", samples.paR, true, 0);
+  visitor("gxL", samples.gxL, true, 0);
+  visitor("gxR", samples.gxR, true, 0);
+  visitor("gyL", samples.gyL, true, 0);
+  visitor("gyR", samples.gyR, true, 0);
+  visitor("rx", samples.rx, true, 0);
+  visitor("ry", samples.ry, true, 0);
+  visitor("gxvelL", samples.gxvelL, true, 0);
+  visitor("gxvelR", samples.gxvelR, true, 0);
+  visitor("gyvelL", samples.gyvelL, true, 0);
+  visitor("gyvelR", samples.gyvelR, true, 0);
+  visitor("hxvelL", samples.hxvelL, true, 0);
+  visitor("hxvelR", samples.hxvelR, true, 0);
+  visitor("hyvelL", samples.hyvelL, true, 0);
+  visitor("hyvelR", samples.hyvelR, true, 0);
+  visitor("rxvelL", samples.rxvelL, true, 0);
+  visitor("rxvelR", samples.rxvelR, true, 0);
+  visitor("ryvelL", samples.ryvelL, true, 0);
+  visitor("ryvelR", samples.ryvelR, true, 0);
+  visitor("fgxvelL", samples.fgxvelL, true, 0);
+  visitor("fgxvelR", samples.fgxvelR, true, 0);
+  visitor("fgyvelL", samples.fgyvelL, true, 0);
+  visitor("fgyvelR", samples.fgyvelR, true, 0);
+  visitor("fhxvelL", samples.fhxvelL, true, 0);
+  visitor("fhxvelR", samples.fhxvelR, true, 0);
+  visitor("fhyvelL", samples.fhyvelL, true, 0);
+  visitor("fhyvelR", samples.fhyvelR, true, 0);
+  visitor("frxvelL", samples.frxvelL, true, 0);
+  visitor("frxvelR", samples.frxvelR, true, 0);
+  visitor("fryvelL", samples.fryvelL, true, 0);
+  visitor("fryvelR", samples.fryvelR, true, 0);
+  visitor("hdata_1", samples.hdata_1, false, 0);
+  visitor("hdata_2", samples.hdata_2, false, 0);
+  visitor("hdata_3", samples.hdata_3, false, 0);
+  visitor("hdata_4", samples.hdata_4, false, 0);
+  visitor("hdata_5", samples.hdata_5, false, 0);
+  visitor("hdata_6", samples.hdata_6, false, 0);
+  visitor("hdata_7", samples.hdata_7, false, 0);
+  visitor("hdata_8", samples.hdata_8, false, 0);
+  visitor("flags", samples.flags, false, 0);
+  visitor("input", samples.input, false, 0);
+  visitor("buttons", samples.buttons, false, 0);
+  visitor("htype", samples.htype, false, 0);
+  visitor("errors", samples.errors, false, 0);
+}
+
+// memory allocated by sample buffers
+typedef struct SAMPLE_BUFFER_SIZE {
+  double bytes;
+
+  template <typename T> void operator()(const char* name, std::vector <T> &values, bool as_double, int code_offset){
+    bytes += (double)values.capacity() * sizeof(T);
+  }
+} SAMPLE_BUFFER_SIZE;
+
+// column file with values in the native R representation
+typedef struct SPILLED_COLUMN {
+  std::string name;
+  std::string filename;
+  bool as_double;
+  double length;
+} SPILLED_COLUMN;
+
+// appends sample buffers to column files and releases their memory
+typedef struct SAMPLE_SPILL {
+  std::string prefix;
+  std::vector <SPILLED_COLUMN> columns;
+  double bytes;
+  bool ok;
+
+  template <typename T> void operator()(const char* name, std::vector <T> &values, bool as_double, int code_offset){
+    size_t iColumn = 0;
+    while (iColumn < columns.size() && columns[iColumn].name != name) iColumn++;
+    if (iColumn == columns.size()){
+      // column is not imported
+      if (values.empty()) return;
+
+      SPILLED_COLUMN column = {name, prefix + "_" + name + ".bin", as_double, 0};
+      columns.push_back(column);
+    }
+
+    FILE* file = fopen(columns[iColumn].filename.c_str(), "ab");
+    ok = ok && file != NULL;
+    if (file != NULL){
+      // converting to R representation, NaN becomes NA
+      const size_t value_size = as_double ? sizeof(double) : sizeof(int);
+      std::vector <double> real_buffer(as_double ? values.size() : 0);
+      std::vector <int> integer_buffer(as_double ? 0 : values.size());
+      for(size_t iValue = 0; iValue < values.size(); iValue++){
+        if (as_double){
+          const double value = values[iValue];
+          real_buffer[iValue] = std::isnan(value) ? NA_REAL : value;
+        }
+        else {
+          integer_buffer[iValue] = (int)values[iValue] + code_offset;
+        }
+      }
+      const void* buffer = as_double ? (const void*)real_buffer.data() : (const void*)integer_buffer.data();
+      ok = ok && fwrite(buffer, value_size, values.size(), file) == values.size();
+      ok = (fclose(file) == 0) && ok;
+      columns[iColumn].length += values.size();
+      bytes += (double)values.size() * value_size;
+    }
+    std::vector <T>().swap(values);
+  }
+} SAMPLE_SPILL;
+
+//' @title Spills sample buffers to disk, if they exceed the memory limit
+//' @param TRIAL_SAMPLES &samples, reference to the trial samples structure
+//' @param SAMPLE_SPILL &spill, reference to the spill state
+//' @param double memory_limit, maximal size of sample buffers in bytes
+//' @keywords internal
+void spill_samples_over_limit(TRIAL_SAMPLES &samples, SAMPLE_SPILL &spill, double memory_limit){
+  SAMPLE_BUFFER_SIZE buffer_size = {0};
+  visit_sample_columns(samples, buffer_size);
+  if (buffer_size.bytes > memory_limit) visit_sample_columns(samples, spill);
+}
+
+// ------------------ filtering samples during the import ------------------
+
+// filters listed columns of the current trial in place, so that raw values are never stored
+typedef struct SAMPLE_FILTER_VISITOR {
+  SIGNAL_FILTER filter;
+  std::vector <std::string> columns;
+  size_t first_row;
+  std::vector <double> time;
+  double dt;
+  bool ok;
+
+  template <typename T> void operator()(const char* name, std::vector <T> &values, bool as_double, int code_offset){
+    if (!as_double || values.size() <= first_row) return;
+    if (std::find(columns.begin(), columns.end(), std::string(name)) == columns.end()) return;
+
+    const size_t rows = values.size() - first_row;
+    std::vector <double> raw(values.begin() + first_row, values.end());
+    std::vector <double> filtered(rows);
+    ok = filter_trial(raw.data(), time.empty() ? NULL : time.data(), rows, dt, filter, filtered.data()) && ok;
+    for(size_t iRow = 0; iRow < rows; iRow++) values[first_row + iRow] = (T)filtered[iRow];
+  }
+} SAMPLE_FILTER_VISITOR;
+
+//' @title Prepares visitor that filters samples during the import
+//' @param List sample_filter, filter specification created by sample_filter()
+//' @return SAMPLE_FILTER_VISITOR
+//' @keywords internal
+SAMPLE_FILTER_VISITOR prepare_sample_filter(List sample_filter){
+  SAMPLE_FILTER_VISITOR visitor;
+  visitor.filter.type = as<int>(sample_filter["type"]);
+  visitor.filter.window = as<int>(sample_filter["window"]);
+  visitor.filter.order = as<int>(sample_filter["order"]);
+  visitor.filter.derivative = as<int>(sample_filter["derivative"]);
+  visitor.filter.cutoff = as<double>(sample_filter["cutoff"]);
+  visitor.columns = as<std::vector <std::string> >(sample_filter["columns"]);
+  visitor.first_row = 0;
+  visitor.dt = 1;
+  visitor.ok = true;
+  return visitor;
+}
+
+//' @title Creates samples table from spilled column files
+//' @description Column files are mapped into memory via map_column_file() that is
+//' defined by the package. Column files are removed, if spilling has failed.
+//' @param SAMPLE_SPILL &spill, reference to the spill state
+//' @return DataFrame, samples table
+//' @keywords internal
+DataFrame mapped_samples(SAMPLE_SPILL &spill){
+  if (!spill.ok){
+    for(size_t iColumn = 0; iColumn < spill.columns.size(); iColumn++) remove(spill.columns[iColumn].filename.c_str());
+    ::Rf_error("Failed to spill samples to disk.");
+  }
+
+  Environment package_env = Environment::namespace_env("eyelinkReader");
+  Function map_column_file("map_column_file", package_env);
+  List samples(spill.columns.size());
+  CharacterVector column_names(spill.columns.size());
+  for(size_t iColumn = 0; iColumn < spill.columns.size(); iColumn++){
+    const SPILLED_COLUMN &column = spill.columns[iColumn];
+    RObject levels = R_NilValue;
+    if (column.name == "eye") levels = CharacterVector::create("LEFT", "RIGHT", "BINOCULAR");
+    samples[iColumn] = map_column_file(column.filename, column.as_double ? "double" : "integer", column.length, levels);
+    column_names[iColumn] = column.name;
+  }
+  const double rows = spill.columns.empty() ? 0 : spill.columns[0].length;
+  samples.attr("names") = column_names;
+  samples.attr("row.names") = NumericVector::create(NA_REAL, -rows);
+  samples.attr("class") = "data.frame";
+  return DataFrame(samples);
+}
+
+//' @title Resets running statistics
+//' @param RUNNING_STATS &stats, reference to the accumulator
+//' @keywords internal
+void reset_running_stats(RUNNING_STATS &stats){
+  stats.n = 0;
+  stats.mean = 0;
+  stats.m2 = 0;
+  stats.min = NA_REAL;
+  stats.max = NA_REAL;
+}
+
+//' @title Adds a single value to running statistics
+//' @description Updates mean and sum of squared deviations via Welford's algorithm,
+//' as well as minimum and maximum. NaN values are ignored.
+//' @param RUNNING_STATS &stats, reference to the accumulator
+//' @param float value, new observation
+//' @keywords internal
+inline void update_running_stats(RUNNING_STATS &stats, float value){
+  if (std::isnan(value)) return;
+
+  stats.n++;
+  double delta = value - stats.mean;
+  stats.mean += delta / stats.n;
+  stats.m2 += delta * (value - stats.mean);
+  if (stats.n == 1 || value < stats.min) stats.min = value;
+  if (stats.n == 1 || value > stats.max) stats.max = value;
+}
+
+//' @title Resets accumulators for both eyes
+//' @param EYE_ACCUMULATOR accumulator[2], left and right eye accumulators
+//' @keywords internal
+void reset_trial_accumulators(EYE_ACCUMULATOR accumulator[2]){
+  for(int iEye = 0; iEye < 2; iEye++){
+    accumulator[iEye].samples = 0;
+    accumulator[iEye].missing_samples = 0;
+    accumulator[iEye].blinks = 0;
+    accumulator[iEye].saccades = 0;
+    accumulator[iEye].peak_velocity = FLOAT_NAN;
+    reset_running_stats(accumulator[iEye].pupil);
+    reset_running_stats(accumulator[iEye].gx);
+    reset_running_stats(accumulator[iEye].gy);
+  }
+}
+
+//' @title Updates trial accumulators with a sample
+//' @description Counts the sample for every eye it was recorded for. Sample counts as missing,
+//' if either of gaze coordinates is missing. Pupil statistics use only positive pupil values.
+//' @param EYE_ACCUMULATOR accumulator[2], left and right eye accumulators
+//' @param FSAMPLE new_sample, structure with sample info, as described in the EDF API manual
+//' @return modifies accumulators
+//' @keywords internal
+void accumulate_sample(EYE_ACCUMULATOR accumulator[2], edfapi::FSAMPLE &new_sample){
+  const edfapi::UINT16 eye_flag[2] = {SAMPLE_LEFT, SAMPLE_RIGHT};
+  for(int iEye = 0; iEye < 2; iEye++){
+    if (!(new_sample.flags & eye_flag[iEye])) continue;
+
+    accumulator[iEye].samples++;
+    float gx = float_or_nan(new_sample.gx[iEye]);
+    float gy = float_or_nan(new_sample.gy[iEye]);
+    if (std::isnan(gx) || std::isnan(gy)){
+      accumulator[iEye].missing_samples++;
+      continue;
+    }
+    update_running_stats(accumulator[iEye].gx, gx);
+    update_running_stats(accumulator[iEye].gy, gy);
+
+    float pupil = float_or_nan(new_sample.pa[iEye]);
+    if (pupil > 0) update_running_stats(accumulator[iEye].pupil, pupil);
+  }
+}
+
+//' @title Updates trial accumulators with an event
+//' @description Counts blinks and saccades, and keeps track of the peak saccade velocity.
+//' @param EYE_ACCUMULATOR accumulator[2], left and right eye accumulators
+//' @param int DataType, type of the event
+//' @param FEVENT new_event, structure with event info, as described in the EDF API manual
+//' @return modifies accumulators
+//' @keywords internal
+void accumulate_event(EYE_ACCUMULATOR accumulator[2], int DataType, edfapi::FEVENT &new_event){
+  if (new_event.eye < 0 || new_event.eye > 1) return;
+  EYE_ACCUMULATOR &eye_accumulator = accumulator[new_event.eye];
+
+  switch(DataType){
+  case ENDBLINK:
+    eye_accumulator.blinks++;
+    break;
+  case ENDSACC: {
+    eye_accumulator.saccades++;
+    float pvel = float_or_nan(new_event.pvel);
+    if (!std::isnan(pvel) && (std::isnan(eye_accumulator.peak_velocity) || pvel > eye_accumulator.peak_velocity)){
+      eye_accumulator.peak_velocity = pvel;
+    }
+    break;
+  }
+  }
+}
+
+//' @title Appends per-eye aggregates of a trial to the summary structure
+//' @description Adds a row for each eye that has either samples or events in the trial.
+//' @param TRIAL_SUMMARY &summary, reference to the trial summary structure
+//' @param EYE_ACCUMULATOR accumulator[2], left and right eye accumulators
+//' @param int iTrial, the index of the trial
+//' @return modifies summary structure
+//' @keywords internal
+void append_trial_summary(TRIAL_SUMMARY &summary, EYE_ACCUMULATOR accumulator[2], unsigned int iTrial){
+  for(int iEye = 0; iEye < 2; iEye++){
+    EYE_ACCUMULATOR &eye_accumulator = accumulator[iEye];
+    if (eye_accumulator.samples == 0 && eye_accumulator.blinks == 0 && eye_accumulator.saccades == 0) continue;
+
+    summary.trial_index.push_back(iTrial+1);
+    summary.eye.push_back(iEye);
+    summary.samples.push_back(eye_accumulator.samples);
+    summary.missing_samples.push_back(eye_accumulator.missing_samples);
+    if (eye_accumulator.samples > 0){
+      summary.data_loss.push_back((double)eye_accumulator.missing_samples / eye_accumulator.samples);
+    }
+    else {
+      summary.data_loss.push_back(NA_REAL);
+    }
+    summary.blinks.push_back(eye_accumulator.blinks);
+    summary.saccades.push_back(eye_accumulator.saccades);
+    summary.peak_velocity.push_back(std::isnan(eye_accumulator.peak_velocity) ? NA_REAL : eye_accumulator.peak_velocity);
+
+    summary.pupil_mean.push_back(eye_accumulator.pupil.n > 0 ? eye_accumulator.pupil.mean : NA_REAL);
+    summary.pupil_sd.push_back(eye_accumulator.pupil.n > 1 ? sqrt(eye_accumulator.pupil.m2 / (eye_accumulator.pupil.n - 1)) : NA_REAL);
+    summary.pupil_min.push_back(eye_accumulator.pupil.min);
+    summary.pupil_max.push_back(eye_accumulator.pupil.max);
+    summary.gx_mean.push_back(eye_accumulator.gx.n > 0 ? eye_accumulator.gx.mean : NA_REAL);
+    summary.gx_sd.push_back(eye_accumulator.gx.n > 1 ? sqrt(eye_accumulator.gx.m2 / (eye_accumulator.gx.n - 1)) : NA_REAL);
+    summary.gy_mean.push_back(eye_accumulator.gy.n > 0 ? eye_accumulator.gy.mean : NA_REAL);
+    summary.gy_sd.push_back(eye_accumulator.gy.n > 1 ? sqrt(eye_accumulator.gy.m2 / (eye_accumulator.gy.n - 1)) : NA_REAL);
+  }
+}
+
+
+//' @title Reads all messages and recording information events of EDF file
+//' @description Scans the file once, decoding only messages and recording information events.
+//' The result is used to resolve trial boundaries for any pair of markers without rescanning the file.
+//' DO NOT call this function directly. Instead, use index_trials function that caches the index.
 //' @param std::string filename, full name of the EDF file
 //' @param int consistency, consistency check control (for the time stamps of the start
 //' and end events, etc). 0, no consistency check. 1, check consistency and report.
 //' 2, check consistency and fix.
-//' @param bool import_events, load/skip loading events.
-//' @param bool import_recordings, load/skip loading recordings.
-//' @param bool import_samples, load/skip loading of samples.
-//' @param LogicalVector sample_attr_flag, boolean vector that indicates which sample fields are to be stored
-//' @param std::string start_marker_string, event that marks trial start. Defaults to "TRIALID", if empty.
-//' @param std::string end_marker_string, event that marks trial end
-//' @param verbose, whether to show progressbar and report number of trials
 //' @export
 //' @keywords internal
-//' @return List, contents of the EDF file. Please see read_edf for details.
+//' @return List with messages (sttime and message) and recordings tables.
 //[[Rcpp::export]]
-List read_edf_file(std::string filename,
-                   int consistency,
-                   bool import_events,
-                   bool import_recordings,
-                   bool import_samples,
-                   LogicalVector sample_attr_flag,
-                   std::string start_marker_string,
-                   std::string end_marker_string,
-                   bool verbose){
-  // data storage
-  TRIAL_EVENTS all_events;
-  TRIAL_SAMPLES all_samples;
-  TRIAL_RECORDINGS all_recordings;
+List read_message_index(std::string filename, int consistency){
+  TRIAL_EVENTS messages;
+  TRIAL_RECORDINGS recordings;
 
-  // collecting all message before the first recording
-  // should contain service information, such as DISPLAY_COORDS
+  acquire_edf_api();
   edfapi::EDFFILE* edfFile = safely_open_edf_file(filename, consistency, 1, 0);
-  for(bool keep_looking = true; keep_looking; ){
-    int DataType = edfapi::edf_get_next_data(edfFile);
-    edfapi::ALLF_DATA* current_data = edfapi::edf_get_float_data(edfFile);
+  for(int DataType = edfapi::edf_get_next_data(edfFile);
+      DataType != NO_PENDING_ITEMS;
+      DataType = edfapi::edf_get_next_data(edfFile)){
     switch(DataType){
     case MESSAGEEVENT:
-      append_event(all_events, current_data->fe, 0, 0);
+      append_event(messages, edfapi::edf_get_float_data(edfFile)->fe, 0, 0);
       break;
     case RECORDING_INFO:
-      // the recording has started, done with preliminaries
-      keep_looking = false;
+      append_recording(recordings, edfapi::edf_get_float_data(edfFile)->rec, 0, 0);
       break;
     }
   }
   edfapi::edf_close_file(edfFile);
+  release_edf_api();
+
+  DataFrame message_table = DataFrame::create(_["sttime"] = messages.sttime,
+                                              _["message"] = messages.message,
+                                              _["stringsAsFactors"] = false);
+  DataFrame recording_table = DataFrame::create(_["time"] = recordings.time,
+                                                _["sample_rate"] = recordings.sample_rate,
+                                                _["eflags"] = recordings.eflags,
+                                                _["sflags"] = recordings.sflags,
+                                                _["state"] = recordings.state,
+                                                _["record_type"] = recordings.record_type,
+                                                _["pupil_type"] = recordings.pupil_type,
+                                                _["recording_mode"] = recordings.recording_mode,
+                                                _["filter_type"] = recordings.filter_type,
+                                                _["pos_type"] = recordings.pos_type,
+                                                _["eye"] = recordings.eye);
+  return List::create(_["messages"] = message_table, _["recordings"] = recording_table);
+}
 
 
-  // opening the edf file to load info trial by trial
-  edfFile = safely_open_edf_file(filename, consistency, import_events, import_samples);
+//' @title Scans trials of EDF file for data quality problems
+//' @description Reads the file sequentially once and inspects only record types and timestamps:
+//' samples, lost data events, and recording information events. Other events are not decoded.
+//' Records are assigned to trials by their time, so trial headers must be sorted by start time
+//' and must not overlap (as resolved by index_trials).
+//' DO NOT call this function directly. Instead, use scan_edf_quality function that converts
+//' counters into a table of issues.
+//' @param std::string filename, full name of the EDF file
+//' @param int consistency, consistency check control (for the time stamps of the start
+//' and end events, etc). 0, no consistency check. 1, check consistency and report.
+//' 2, check consistency and fix.
+//' @param NumericMatrix trial_headers, trial headers resolved from a message index (see index_trials).
+//' @param double max_gap, interval between consecutive samples (in milliseconds) that is counted as a gap.
+//' NA, 1.5 sampling intervals (but at least 1.5 ms) based on the sampling rate of the trial.
+//' @export
+//' @keywords internal
+//' @return data.frame with \code{trial}, \code{samples}, \code{lost_data} (number of lost data events),
+//' \code{sample_rate_changes} (number of recording information events with a sampling rate different
+//' from the previous one), \code{last_sample_rate}, \code{gaps} (number of gaps between samples), and
+//' \code{longest_gap} (in milliseconds, 0 if there are no gaps) columns.
+//[[Rcpp::export]]
+DataFrame scan_trial_quality(std::string filename, int consistency, NumericMatrix trial_headers, double max_gap){
+  const int total_trials = trial_headers.nrow();
+  TRIAL_QUALITY quality;
+  std::vector <double> gap_threshold(total_trials);
+  std::vector <double> last_sample_time(total_trials, NA_REAL);
+  for(int iTrial = 0; iTrial < total_trials; iTrial++){
+    quality.samples.push_back(0);
+    quality.lost_data.push_back(0);
+    quality.sample_rate_changes.push_back(0);
+    quality.last_sample_rate.push_back(trial_headers(iTrial, 5));
+    quality.gaps.push_back(0);
+    quality.longest_gap.push_back(0);
+
+    const double sample_rate = trial_headers(iTrial, 5);
+    if (!ISNAN(max_gap)) gap_threshold[iTrial] = max_gap;
+    else if (!ISNAN(sample_rate) && sample_rate > 0) gap_threshold[iTrial] = 1.5 * std::max(1000.0 / sample_rate, 1.0);
+    else gap_threshold[iTrial] = R_PosInf;
+  }
 
-  // set the trial navigation up
-  set_trial_navigation_up(edfFile, start_marker_string, end_marker_string);
+  acquire_edf_api();
+  edfapi::EDFFILE* edfFile = safely_open_edf_file(filename, consistency, 1, 1);
+  int iTrial = 0;
+  for(int DataType = edfapi::edf_get_next_data(edfFile);
+      DataType != NO_PENDING_ITEMS && iTrial < total_trials;
+      DataType = edfapi::edf_get_next_data(edfFile)){
+    if (DataType != SAMPLE_TYPE && DataType != LOST_DATA_EVENT && DataType != RECORDING_INFO) continue;
 
-  // figure out, just how many trials we have
-  unsigned int total_trials = edfapi::edf_get_trial_count(edfFile);
-  if (verbose){
-    ::Rprintf("Trials count: %d\n", total_trials);
+    edfapi::ALLF_DATA* current_data = edfapi::edf_get_float_data(edfFile);
+    double record_time = current_data->fe.sttime;
+    if (DataType == SAMPLE_TYPE) record_time = current_data->fs.time;
+    if (DataType == RECORDING_INFO) record_time = current_data->rec.time;
+
+    // records after the trial belong to one of the later trials, trials of zero duration are skipped
+    while (iTrial < total_trials && (record_time > trial_headers(iTrial, 3) || trial_headers(iTrial, 3) <= trial_headers(iTrial, 2))) iTrial++;
+    if (iTrial == total_trials) break;
+    if (record_time < trial_headers(iTrial, 2)) continue;
+
+    switch(DataType){
+    case SAMPLE_TYPE:
+      quality.samples[iTrial]++;
+      if (!ISNAN(last_sample_time[iTrial])){
+        const double interval = record_time - last_sample_time[iTrial];
+        if (interval > gap_threshold[iTrial]){
+          quality.gaps[iTrial]++;
+          quality.longest_gap[iTrial] = std::max(quality.longest_gap[iTrial], interval);
+        }
+      }
+      last_sample_time[iTrial] = record_time;
+      break;
+    case LOST_DATA_EVENT:
+      quality.lost_data[iTrial]++;
+      break;
+    case RECORDING_INFO:
+      if (current_data->rec.state == 1 && current_data->rec.sample_rate != quality.last_sample_rate[iTrial]){
+        if (!ISNAN(quality.last_sample_rate[iTrial])) quality.sample_rate_changes[iTrial]++;
+        quality.last_sample_rate[iTrial] = current_data->rec.sample_rate;
+      }
+      break;
+    }
   }
+  edfapi::edf_close_file(edfFile);
+  release_edf_api();
+
+  NumericVector trial(total_trials);
+  for(int iTrial = 0; iTrial < total_trials; iTrial++) trial[iTrial] = trial_headers(iTrial, 0);
+  return DataFrame::create(_["trial"] = trial,
+                           _["samples"] = quality.samples,
+                           _["lost_data"] = quality.lost_data,
+                           _["sample_rate_changes"] = quality.sample_rate_changes,
+                           _["last_sample_rate"] = quality.last_sample_rate,
+                           _["gaps"] = quality.gaps,
+                           _["longest_gap"] = quality.longest_gap);
+}
 
-  // creating headers, events, and samples
-  NumericMatrix trial_headers = prepare_trial_headers(total_trials);
 
+// ------------------ importing trials on a worker thread ------------------
+
+// state of an import, see edf_import_progress
+enum IMPORT_STATUS {IMPORT_RUNNING, IMPORT_DONE, IMPORT_CANCELLED, IMPORT_FAILED};
+
+// parameters, decoded data, and progress of a single import.
+// The worker thread owns everything but the progress counters and the cancellation flag
+// until it has finished, the main thread converts data to R objects afterwards.
+typedef struct EDF_IMPORT {
+  // parameters
+  std::string filename;
+  bool import_events;
+  bool import_recordings;
+  bool import_samples;
+  bool import_trial_summary;
+  std::vector <bool> sample_attr_flag;
+  double memory_limit;
+  bool limit_memory;
+  bool filter_samples;
+  std::string start_marker_string;
+  std::string end_marker_string;
+  bool sequential_scan;
+  NumericMatrix trial_index;
+  bool block_mode;
+
+  // file and decoded data
+  edfapi::EDFFILE* edfFile;
+  TRIAL_HEADERS trial_headers;
+  TRIAL_HEADERS block_headers;
+  TRIAL_EVENTS all_events;
+  TRIAL_SAMPLES all_samples;
+  TRIAL_RECORDINGS all_recordings;
+  TRIAL_SUMMARY trial_summary;
+  SAMPLE_SPILL spill;
+  SAMPLE_FILTER_VISITOR filter_visitor;
+  std::vector <unsigned int> skipped_trials;
+  std::string error;
+  bool collected;
+
+  // shared with the main thread
+  std::thread worker;
+  std::atomic <int> status;
+  std::atomic <bool> cancel_requested;
+  std::atomic <bool> trials_counted;
+  std::atomic <unsigned int> total_trials;
+  std::atomic <unsigned int> trials_done;
+  std::atomic <double> samples_decoded;
+  std::atomic <double> bytes_decoded;
+} EDF_IMPORT;
+
+//' @title Filters samples of a single trial and spills sample buffers over the memory limit
+//' @description Samples from first_row till the end of the buffers must belong to the same trial,
+//' so that filters never smooth across trials. Buffers are spilled only after samples were filtered.
+//' @param EDF_IMPORT* job, import with the sample filter
+//' @param size_t first_row, first sample of the trial in the buffers
+//' @param double sample_rate, sampling rate of the trial in Hz
+//' @return bool, false if the filter could not be applied
+//' @keywords internal
+bool filter_trial_samples(EDF_IMPORT* job, size_t first_row, double sample_rate){
+  SAMPLE_FILTER_VISITOR &filter_visitor = job->filter_visitor;
+  filter_visitor.first_row = first_row;
+  filter_visitor.time.assign(job->all_samples.time.begin() + std::min(first_row, job->all_samples.time.size()), job->all_samples.time.end());
+  filter_visitor.dt = 1000.0 / sample_rate;
+  visit_sample_columns(job->all_samples, filter_visitor);
+  if (!filter_visitor.ok) return false;
+  if (job->limit_memory) spill_samples_over_limit(job->all_samples, job->spill, job->memory_limit);
+  return true;
+}
+
+//' @title Imports all trials of an opened EDF file
+//' @description Body of the worker thread: sets trial navigation up (unless trials were resolved
+//' from a message index), reads trials one by one, and closes the file. Does not use R API: errors are
+//' stored in job.error and trials with zero or negative duration in job.skipped_trials. Cancellation
+//' is checked before every trial and every few thousand records. In the block mode, recording blocks
+//' are read instead of trials (so that records between trials are kept) and every record is assigned
+//' to the trial that contains it, 0 if none.
+//' @param EDF_IMPORT* job, import that was prepared via prepare_edf_import
+//' @keywords internal
+void import_edf_trials(EDF_IMPORT* job){
+  // sample buffers are spilled to disk, once they exceed the memory limit
+  const unsigned int check_interval = 4096;
+  unsigned int records_since_check = 0;
+  unsigned int samples_since_check = 0;
+  double decoded_samples = 0;
+  double decoded_bytes = 0;
+
+  edfapi::EDFFILE* edfFile = job->edfFile;
+  TRIAL_HEADERS &trial_headers = job->trial_headers;
+
+  // units of work: either trials or recording blocks that are read sequentially
+  TRIAL_HEADERS &units = job->block_mode ? job->block_headers : trial_headers;
+
+  // trials are either resolved from the message index or via EDF API trial navigation,
+  // which rescans the file
+  if (!job->sequential_scan){
+    if (!set_trial_navigation_up(edfFile, job->start_marker_string, job->end_marker_string)){
+      job->error = "Error while setting up trial navigation identifier";
+    }
+    else {
+      trial_headers.rows = edfapi::edf_get_trial_count(edfFile);
+      trial_headers.values.assign(trial_headers.rows * 15, 0);
+    }
+  }
+  const unsigned int total_trials = job->error.empty() ? units.rows : 0;
+  job->total_trials = total_trials;
+  job->trials_counted = true;
+
+  // record that belongs to a later trial during the sequential scan
+  int pending_type = NO_PENDING_ITEMS;
 
   // looping over the trials
-  Progress trial_counter(total_trials, verbose);
-  for(unsigned int iTrial = 0; iTrial< total_trials; iTrial++){
-    // visuals and interaction
-    if (verbose){
-      if (Progress::check_abort() ){
+  for(unsigned int iTrial = 0; iTrial< total_trials && job->error.empty() && !job->cancel_requested; iTrial++){
+    if (!job->sequential_scan){
+      // read headers
+      if (!jump_to_trial(edfFile, iTrial) || !read_trial_header(edfFile, trial_headers, iTrial)){
+        std::stringstream error_message_stream;
+        error_message_stream << "Error obtaining the header for the trial " << iTrial+1;
+        job->error = error_message_stream.str();
         break;
       }
-      trial_counter.increment();
     }
 
-    jump_to_trial(edfFile, iTrial);
-
-    // read headers
-    read_trial_header(edfFile, trial_headers, iTrial);
-
     // read trial
     edfapi::ALLF_DATA* current_data;
-    edfapi::UINT32 trial_start_time = trial_headers(iTrial, 2);
-    edfapi::UINT32 trial_end_time = trial_headers(iTrial, 3);
+    edfapi::UINT32 trial_start_time = units(iTrial, 2);
+    edfapi::UINT32 trial_end_time = units(iTrial, 3);
     if (trial_end_time <= trial_start_time){
-      ::warning("Skipping trial %d due to zero or negative duration.", iTrial+1);
+      job->skipped_trials.push_back(iTrial);
+      job->trials_done++;
       continue;
     }
 
     bool TrialIsOver = false;
     edfapi::UINT32 data_timestamp = 0;
-    for(int DataType = edfapi::edf_get_next_data(edfFile);
+    // in the block mode, a block holds several trials that are filtered (and spilled) one by one
+    size_t trial_first_sample = job->all_samples.trial_index.size();
+    EYE_ACCUMULATOR trial_accumulator[2];
+    reset_trial_accumulators(trial_accumulator);
+    int DataType = pending_type != NO_PENDING_ITEMS ? pending_type : edfapi::edf_get_next_data(edfFile);
+    pending_type = NO_PENDING_ITEMS;
+    for(;
         (DataType != NO_PENDING_ITEMS) && !TrialIsOver;
         DataType = edfapi::edf_get_next_data(edfFile)){
 
+      // publishing progress and checking for cancellation
+      if (++records_since_check == check_interval){
+        records_since_check = 0;
+        job->samples_decoded = decoded_samples;
+        job->bytes_decoded = decoded_bytes;
+        if (job->cancel_requested) break;
+      }
+
+      // recording info that would be discarded is not decoded
+      if (DataType == RECORDING_INFO && !job->import_recordings) continue;
+
       // obtaining next data piece
       current_data = edfapi::edf_get_float_data(edfFile);
+
+      // sequential scan: records before the trial are skipped, a record after it is kept for the next trial
+      if (job->sequential_scan){
+        edfapi::UINT32 record_time = current_data->fe.sttime;
+        if (DataType == SAMPLE_TYPE) record_time = current_data->fs.time;
+        if (DataType == RECORDING_INFO) record_time = current_data->rec.time;
+        if (record_time < trial_start_time) continue;
+        if (record_time > trial_end_time){
+          pending_type = DataType;
+          break;
+        }
+      }
       switch(DataType){
       case SAMPLE_TYPE:
         data_timestamp = current_data->fs.time;
-        if (import_samples){
-          append_sample(all_samples, current_data->fs, iTrial, trial_start_time, sample_attr_flag);
+        decoded_samples++;
+        decoded_bytes += sizeof(edfapi::FSAMPLE);
+        if (job->import_samples && job->block_mode){
+          // trial index and relative time of samples between trials refer to the block
+          edfapi::UINT32 sample_trial_start = trial_start_time;
+          const unsigned int sample_trial = locate_trial(trial_headers, current_data->fs.time, sample_trial_start);
+          if (job->filter_samples && job->all_samples.trial_index.size() > trial_first_sample &&
+              job->all_samples.trial_index.back() != sample_trial){
+            if (!filter_trial_samples(job, trial_first_sample, units(iTrial, 5))){
+              job->error = "Butterworth filter cutoff must be below the Nyquist frequency (half of the sampling rate).";
+              TrialIsOver = true;
+              break;
+            }
+            trial_first_sample = job->all_samples.trial_index.size();
+          }
+          append_sample(job->all_samples, current_data->fs, iTrial, sample_trial_start, job->sample_attr_flag);
+          job->all_samples.trial_index.back() = sample_trial;
+          job->all_samples.block_index.push_back(iTrial + 1);
+        }
+        else if (job->import_samples){
+          append_sample(job->all_samples, current_data->fs, iTrial, trial_start_time, job->sample_attr_flag);
+        }
+        if (job->import_samples && job->limit_memory && !job->filter_samples && ++samples_since_check == check_interval){
+          samples_since_check = 0;
+          spill_samples_over_limit(job->all_samples, job->spill, job->memory_limit);
+        }
+        if (job->import_trial_summary){
+          accumulate_sample(trial_accumulator, current_data->fs);
         }
         break;
 
@@ -701,20 +1401,36 @@ List read_edf_file(std::string filename,
       case INPUTEVENT:
       case LOST_DATA_EVENT:
         data_timestamp = current_data->fe.sttime;
+        decoded_bytes += sizeof(edfapi::FEVENT);
         if (data_timestamp > trial_end_time)
         {
           TrialIsOver = true;
           break;
         }
-        if (import_events){
-          append_event(all_events, current_data->fe, iTrial + 1, trial_start_time);
+        if (job->import_events && job->block_mode){
+          edfapi::UINT32 event_trial_start = trial_start_time;
+          const unsigned int event_trial = locate_trial(trial_headers, current_data->fe.sttime, event_trial_start);
+          append_event(job->all_events, current_data->fe, event_trial, event_trial_start);
+        }
+        else if (job->import_events){
+          append_event(job->all_events, current_data->fe, iTrial + 1, trial_start_time);
+        }
+        if (job->import_trial_summary){
+          accumulate_event(trial_accumulator, DataType, current_data->fe);
         }
         break;
 
       case RECORDING_INFO:
         data_timestamp = current_data->fe.time;
-        if (import_recordings){
-          append_recording(all_recordings, current_data->rec, iTrial, trial_start_time);
+        decoded_bytes += sizeof(edfapi::RECORDINGS);
+        if (job->import_recordings && job->block_mode){
+          edfapi::UINT32 recording_trial_start = trial_start_time;
+          const unsigned int recording_trial = locate_trial(trial_headers, current_data->rec.time, recording_trial_start);
+          append_recording(job->all_recordings, current_data->rec, iTrial, recording_trial_start);
+          job->all_recordings.trial_index.back() = recording_trial;
+        }
+        else if (job->import_recordings){
+          append_recording(job->all_recordings, current_data->rec, iTrial, trial_start_time);
         }
         break;
       case NO_PENDING_ITEMS:
@@ -725,196 +1441,600 @@ List read_edf_file(std::string filename,
       if (data_timestamp > trial_end_time)
         break;
     }
+
+    // a trial interrupted by cancellation or a failed filter is not filtered or summarized
+    if (job->cancel_requested || !job->error.empty()) break;
+
+    if (job->filter_samples && !filter_trial_samples(job, trial_first_sample, units(iTrial, 5))){
+      job->error = "Butterworth filter cutoff must be below the Nyquist frequency (half of the sampling rate).";
+      break;
+    }
+
+    if (job->import_trial_summary){
+      append_trial_summary(job->trial_summary, trial_accumulator, iTrial);
+    }
+    job->trials_done++;
   }
 
-  // closing file
+  // closing file, other calls can use the EDF API again
   edfapi::edf_close_file(edfFile);
+  job->edfFile = NULL;
+  release_edf_api();
+
+  job->samples_decoded = decoded_samples;
+  job->bytes_decoded = decoded_bytes;
+  if (!job->error.empty()) job->status = IMPORT_FAILED;
+  else if (job->cancel_requested) job->status = IMPORT_CANCELLED;
+  else job->status = IMPORT_DONE;
+}
+
+//' @title Prepares import of EDF file
+//' @description Prepares the sample filter and the spill, collects service messages before the first
+//' recording, and opens the file for the worker thread. Must be called from the main thread.
+//' See read_edf_file for parameters.
+//' @return EDF_IMPORT*, new import that must be started and eventually deleted
+//' @keywords internal
+EDF_IMPORT* prepare_edf_import(std::string filename,
+                               int consistency,
+                               bool import_events,
+                               bool import_recordings,
+                               bool import_samples,
+                               bool import_trial_summary,
+                               LogicalVector sample_attr_flag,
+                               double memory_limit,
+                               std::string start_marker_string,
+                               std::string end_marker_string,
+                               Nullable<NumericMatrix> trial_index,
+                               Nullable<NumericMatrix> recording_blocks,
+                               Nullable<List> sample_filter){
+  // samples are filtered trial by trial, buffers are spilled only between trials
+  const bool filter_samples = import_samples && sample_filter.isNotNull();
+  SAMPLE_FILTER_VISITOR filter_visitor;
+  if (filter_samples) filter_visitor = prepare_sample_filter(List(sample_filter.get()));
+
+  // sample buffers are spilled to disk, once they exceed the memory limit
+  const bool limit_memory = import_samples && R_FINITE(memory_limit);
+  std::string spill_prefix;
+  if (limit_memory){
+    Function tempfile("tempfile");
+    spill_prefix = as<std::string>(tempfile("eyelinkReader_samples"));
+  }
+
+  // collecting all message before the first recording
+  // should contain service information, such as DISPLAY_COORDS.
+  // The EDF API stays acquired till the worker thread closes the file.
+  TRIAL_EVENTS service_events;
+  acquire_edf_api();
+  edfapi::EDFFILE* edfFile = safely_open_edf_file(filename, consistency, 1, 0);
+  for(bool keep_looking = true; keep_looking; ){
+    int DataType = edfapi::edf_get_next_data(edfFile);
+    switch(DataType){
+    case MESSAGEEVENT:
+      append_event(service_events, edfapi::edf_get_float_data(edfFile)->fe, 0, 0);
+      break;
+    case RECORDING_INFO:
+    case NO_PENDING_ITEMS:
+      // the recording has started (or there is none), done with preliminaries
+      keep_looking = false;
+      break;
+    }
+  }
+  edfapi::edf_close_file(edfFile);
+
+  // opening the edf file to load info trial by trial
+  // (summary needs both samples and events, even if neither is imported)
+  edfFile = safely_open_edf_file(filename, consistency, import_events || import_trial_summary, import_samples || import_trial_summary);
+
+  EDF_IMPORT* job = new EDF_IMPORT();
+  job->filename = filename;
+  job->import_events = import_events;
+  job->import_recordings = import_recordings;
+  job->import_samples = import_samples;
+  job->import_trial_summary = import_trial_summary;
+  job->sample_attr_flag = as<std::vector <bool> >(sample_attr_flag);
+  job->memory_limit = memory_limit;
+  job->limit_memory = limit_memory;
+  job->filter_samples = filter_samples;
+  job->filter_visitor = filter_visitor;
+  job->start_marker_string = start_marker_string;
+  job->end_marker_string = end_marker_string;
+  job->edfFile = edfFile;
+  job->all_events = service_events;
+  job->spill.prefix = spill_prefix;
+  job->spill.bytes = 0;
+  job->spill.ok = true;
+  job->collected = false;
+  job->status = IMPORT_RUNNING;
+  job->cancel_requested = false;
+  job->trials_counted = false;
+  job->total_trials = 0;
+  job->trials_done = 0;
+  job->samples_decoded = 0;
+  job->bytes_decoded = 0;
+
+  // trials resolved from the message index
+  job->sequential_scan = trial_index.isNotNull();
+  job->trial_headers.rows = 0;
+  if (job->sequential_scan){
+    job->trial_index = NumericMatrix(trial_index.get());
+    job->trial_headers.rows = job->trial_index.nrow();
+    job->trial_headers.values.assign(job->trial_index.begin(), job->trial_index.end());
+  }
+
+  // recording blocks are read instead of trials
+  job->block_mode = job->sequential_scan && recording_blocks.isNotNull();
+  job->block_headers.rows = 0;
+  if (job->block_mode){
+    NumericMatrix blocks(recording_blocks.get());
+    job->block_headers.rows = blocks.nrow();
+    job->block_headers.values.assign(blocks.begin(), blocks.end());
+  }
+  return job;
+}
+
+//' @title Removes column files of spilled samples
+//' @param SAMPLE_SPILL &spill, reference to the spill state
+//' @keywords internal
+void remove_spilled_columns(SAMPLE_SPILL &spill){
+  for(size_t iColumn = 0; iColumn < spill.columns.size(); iColumn++) remove(spill.columns[iColumn].filename.c_str());
+  spill.columns.clear();
+}
+
+//' @title Finalizer of an import handle
+//' @description Cancels the import, waits for the worker thread, removes column files of samples that
+//' were never collected, and frees memory.
+//' @param EDF_IMPORT* job
+//' @keywords internal
+void finalize_edf_import(EDF_IMPORT* job){
+  job->cancel_requested = true;
+  if (job->worker.joinable()) job->worker.join();
+  if (job->edfFile != NULL){
+    // worker thread was never started
+    edfapi::edf_close_file(job->edfFile);
+    release_edf_api();
+  }
+  if (!job->collected) remove_spilled_columns(job->spill);
+  delete job;
+}
+
+//' @title Waits for the worker thread for a short while
+//' @description Sleeps for a few milliseconds and checks for a user interrupt without
+//' a long jump, so that the caller can cancel the import cleanly.
+//' @return bool, false if the user has interrupted.
+//' @keywords internal
+bool wait_for_edf_import(){
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  try {
+    Rcpp::checkUserInterrupt();
+  } catch(Rcpp::internal::InterruptedException &) {
+    return false;
+  }
+  return true;
+}
+
+//' @title Converts data decoded by a finished import into R objects
+//' @description Reports skipped trials as warnings. Memory of decoded data is released afterwards.
+//' @param EDF_IMPORT &job, finished import (the worker thread was joined) that has not failed
+//' @return List, contents of the EDF file. Please see read_edf for details.
+//' @keywords internal
+List collect_edf_recording(EDF_IMPORT &job){
+  job.collected = true;
+  for(size_t iSkipped = 0; iSkipped < job.skipped_trials.size(); iSkipped++){
+    ::warning("Skipping %s %d due to zero or negative duration.", job.block_mode ? "recording block" : "trial", job.skipped_trials[iSkipped]+1);
+  }
 
   // returning data
   List edf_recording;
-  edf_recording["headers"] = trial_headers;
+  if (job.sequential_scan){
+    edf_recording["headers"] = job.trial_index;
+  }
+  else {
+    NumericMatrix trial_headers = prepare_trial_headers(job.trial_headers.rows);
+    std::copy(job.trial_headers.values.begin(), job.trial_headers.values.end(), trial_headers.begin());
+    edf_recording["headers"] = trial_headers;
+  }
 
   // converting structure of vectors into a data frame
-  if (import_events){
+  if (job.import_events){
     DataFrame events;
-    events["trial"] = all_events.trial_index;
-    events["time"] = all_events.time;
-    events["type"] = all_events.type;
-    events["read"] = all_events.read;
-    events["sttime"] = all_events.sttime;
-    events["entime"] = all_events.entime;
-    events["sttime_rel"] = all_events.sttime_rel;
-    events["entime_rel"] = all_events.entime_rel;
-    events["hstx"] = all_events.hstx;
-    events["hsty"] = all_events.hsty;
-    events["gstx"] = all_events.gstx;
-    events["gsty"] = all_events.gsty;
-    events["sta"] = all_events.sta;
-    events["henx"] = all_events.henx;
-    events["heny"] = all_events.heny;
-    events["genx"] = all_events.genx;
-    events["geny"] = all_events.geny;
-    events["ena"] = all_events.ena;
-    events["havx"] = all_events.havx;
-    events["havy"] = all_events.havy;
-    events["gavx"] = all_events.gavx;
-    events["gavy"] = all_events.gavy;
-    events["ava"] = all_events.ava;
-    events["avel"] = all_events.avel;
-    events["pvel"] = all_events.pvel;
-    events["svel"] = all_events.svel;
-    events["evel"] = all_events.evel;
-    events["supd_x"] = all_events.supd_x;
-    events["eupd_x"] = all_events.eupd_x;
-    events["supd_y"] = all_events.supd_y;
-    events["eupd_y"] = all_events.eupd_y;
-    events["eye"] = all_events.eye;
-    events["status"] = all_events.status;
-    events["flags"] = all_events.flags;
-    events["input"] = all_events.input;
-    events["buttons"] = all_events.buttons;
-    events["parsedby"] = all_events.parsedby;
-    events["message"] = all_events.message;
+    events["trial"] = job.all_events.trial_index;
+    events["time"] = job.all_events.time;
+    events["type"] = job.all_events.type;
+    events["read"] = job.all_events.read;
+    events["sttime"] = job.all_events.sttime;
+    events["entime"] = job.all_events.entime;
+    events["sttime_rel"] = job.all_events.sttime_rel;
+    events["entime_rel"] = job.all_events.entime_rel;
+    events["hstx"] = job.all_events.hstx;
+    events["hsty"] = job.all_events.hsty;
+    events["gstx"] = job.all_events.gstx;
+    events["gsty"] = job.all_events.gsty;
+    events["sta"] = job.all_events.sta;
+    events["henx"] = job.all_events.henx;
+    events["heny"] = job.all_events.heny;
+    events["genx"] = job.all_events.genx;
+    events["geny"] = job.all_events.geny;
+    events["ena"] = job.all_events.ena;
+    events["havx"] = job.all_events.havx;
+    events["havy"] = job.all_events.havy;
+    events["gavx"] = job.all_events.gavx;
+    events["gavy"] = job.all_events.gavy;
+    events["ava"] = job.all_events.ava;
+    events["avel"] = job.all_events.avel;
+    events["pvel"] = job.all_events.pvel;
+    events["svel"] = job.all_events.svel;
+    events["evel"] = job.all_events.evel;
+    events["supd_x"] = job.all_events.supd_x;
+    events["eupd_x"] = job.all_events.eupd_x;
+    events["supd_y"] = job.all_events.supd_y;
+    events["eupd_y"] = job.all_events.eupd_y;
+    events["eye"] = job.all_events.eye;
+    events["status"] = job.all_events.status;
+    events["flags"] = job.all_events.flags;
+    events["input"] = job.all_events.input;
+    events["buttons"] = job.all_events.buttons;
+    events["parsedby"] = job.all_events.parsedby;
+    events["message"] = job.all_events.message;
     edf_recording["events"] = events;
   }
 
-  if (import_recordings){
+  if (job.import_recordings){
     DataFrame recordings;
-    recordings["trial_index"] = all_recordings.trial_index;
-    recordings["time"] = all_recordings.time;
-    recordings["time_rel"] = all_recordings.time_rel;
-    recordings["sample_rate"] = all_recordings.sample_rate;
-    recordings["eflags"] = all_recordings.eflags;
-    recordings["sflags"] = all_recordings.sflags;
-    recordings["state"] = all_recordings.state;
-    recordings["record_type"] = all_recordings.record_type;
-    recordings["pupil_type"] = all_recordings.pupil_type;
-    recordings["recording_mode"] = all_recordings.recording_mode;
-    recordings["filter_type"] = all_recordings.filter_type;
-    recordings["pos_type"] = all_recordings.pos_type;
-    recordings["eye"] = all_recordings.eye;
+    recordings["trial_index"] = job.all_recordings.trial_index;
+    recordings["time"] = job.all_recordings.time;
+    recordings["time_rel"] = job.all_recordings.time_rel;
+    recordings["sample_rate"] = job.all_recordings.sample_rate;
+    recordings["eflags"] = job.all_recordings.eflags;
+    recordings["sflags"] = job.all_recordings.sflags;
+    recordings["state"] = job.all_recordings.state;
+    recordings["record_type"] = job.all_recordings.record_type;
+    recordings["pupil_type"] = job.all_recordings.pupil_type;
+    recordings["recording_mode"] = job.all_recordings.recording_mode;
+    recordings["filter_type"] = job.all_recordings.filter_type;
+    recordings["pos_type"] = job.all_recordings.pos_type;
+    recordings["eye"] = job.all_recordings.eye;
     edf_recording["recordings"] = recordings;
   }
 
-  if (import_samples){
+  if (job.import_trial_summary){
+    DataFrame summary;
+    summary["trial"] = job.trial_summary.trial_index;
+    summary["eye"] = job.trial_summary.eye;
+    summary["samples"] = job.trial_summary.samples;
+    summary["missing_samples"] = job.trial_summary.missing_samples;
+    summary["data_loss"] = job.trial_summary.data_loss;
+    summary["blinks"] = job.trial_summary.blinks;
+    summary["saccades"] = job.trial_summary.saccades;
+    summary["peak_velocity"] = job.trial_summary.peak_velocity;
+    summary["pupil_mean"] = job.trial_summary.pupil_mean;
+    summary["pupil_sd"] = job.trial_summary.pupil_sd;
+    summary["pupil_min"] = job.trial_summary.pupil_min;
+    summary["pupil_max"] = job.trial_summary.pupil_max;
+    summary["gx_mean"] = job.trial_summary.gx_mean;
+    summary["gx_sd"] = job.trial_summary.gx_sd;
+    summary["gy_mean"] = job.trial_summary.gy_mean;
+    summary["gy_sd"] = job.trial_summary.gy_sd;
+    edf_recording["trial_summary"] = summary;
+  }
+
+  if (job.import_samples && !job.spill.columns.empty()){
+    // remaining samples are spilled as well, so that all columns are memory-mapped
+    visit_sample_columns(job.all_samples, job.spill);
+    edf_recording["samples"] = mapped_samples(job.spill);
+  }
+  else if (job.import_samples){
     DataFrame samples;
-    samples["trial"] = all_samples.trial_index;
-    samples["eye"] = all_samples.eye;
-    if (sample_attr_flag[0]){
-      samples["time"] = all_samples.time;
-      samples["time_rel"] = all_samples.time_rel;
-    }
-    if (sample_attr_flag[1]){
-      samples["pxL"] = all_samples.pxL;
-      samples["pxR"] = all_samples.pxR;
+    samples["trial"] = job.all_samples.trial_index;
+    if (job.block_mode) samples["block"] = job.all_samples.block_index;
+    samples["eye"] = job.all_samples.eye;
+    if (job.sample_attr_flag[0]){
+      samples["time"] = job.all_samples.time;
+      samples["time_rel"] = job.all_samples.time_rel;
+    }
+    if (job.sample_attr_flag[1]){
+      samples["pxL"] = job.all_samples.pxL;
+      samples["pxR"] = job.all_samples.pxR;
     }
-    if (sample_attr_flag[2]){
-      samples["pyL"] = all_samples.pyL;
-      samples["pyR"] = all_samples.pyR;
+    if (job.sample_attr_flag[2]){
+      samples["pyL"] = job.all_samples.pyL;
+      samples["pyR"] = job.all_samples.pyR;
     }
-    if (sample_attr_flag[3]){
-      samples["hxL"] = all_samples.hxL;
-      samples["hxR"] = all_samples.hxR;
+    if (job.sample_attr_flag[3]){
+      samples["hxL"] = job.all_samples.hxL;
+      samples["hxR"] = job.all_samples.hxR;
     }
-    if (sample_attr_flag[4]){
-      samples["hyL"] = all_samples.hyL;
-      samples["hyR"] = all_samples.hyR;
+    if (job.sample_attr_flag[4]){
+      samples["hyL"] = job.all_samples.hyL;
+      samples["hyR"] = job.all_samples.hyR;
     }
-    if (sample_attr_flag[5]){
-      samples["paL"] = all_samples.paL;
-      samples["paR"] = all_samples.paR;
+    if (job.sample_attr_flag[5]){
+      samples["paL"] = job.all_samples.paL;
+      samples["paR"] = job.all_samples.paR;
     }
-    if (sample_attr_flag[6]){
-      samples["gxL"] = all_samples.gxL;
-      samples["gxR"] = all_samples.gxR;
+    if (job.sample_attr_flag[6]){
+      samples["gxL"] = job.all_samples.gxL;
+      samples["gxR"] = job.all_samples.gxR;
     }
-    if (sample_attr_flag[7]){
-      samples["gyL"] = all_samples.gyL;
-      samples["gyR"] = all_samples.gyR;
+    if (job.sample_attr_flag[7]){
+      samples["gyL"] = job.all_samples.gyL;
+      samples["gyR"] = job.all_samples.gyR;
     }
-    if (sample_attr_flag[8]){
-      samples["rx"] = all_samples.rx;
+    if (job.sample_attr_flag[8]){
+      samples["rx"] = job.all_samples.rx;
     }
-    if (sample_attr_flag[9]){
-      samples["ry"] = all_samples.ry;
+    if (job.sample_attr_flag[9]){
+      samples["ry"] = job.all_samples.ry;
     }
-    if (sample_attr_flag[10]){
-      samples["gxvelL"] = all_samples.gxvelL;
-      samples["gxvelR"] = all_samples.gxvelR;
+    if (job.sample_attr_flag[10]){
+      samples["gxvelL"] = job.all_samples.gxvelL;
+      samples["gxvelR"] = job.all_samples.gxvelR;
     }
-    if (sample_attr_flag[11]){
-      samples["gyvelL"] = all_samples.gyvelL;
-      samples["gyvelR"] = all_samples.gyvelR;
+    if (job.sample_attr_flag[11]){
+      samples["gyvelL"] = job.all_samples.gyvelL;
+      samples["gyvelR"] = job.all_samples.gyvelR;
     }
-    if (sample_attr_flag[12]){
-      samples["hxvelL"] = all_samples.hxvelL;
-      samples["hxvelR"] = all_samples.hxvelR;
+    if (job.sample_attr_flag[12]){
+      samples["hxvelL"] = job.all_samples.hxvelL;
+      samples["hxvelR"] = job.all_samples.hxvelR;
     }
-    if (sample_attr_flag[13]){
-      samples["hyvelL"] = all_samples.hyvelL;
-      samples["hyvelR"] = all_samples.hyvelR;
+    if (job.sample_attr_flag[13]){
+      samples["hyvelL"] = job.all_samples.hyvelL;
+      samples["hyvelR"] = job.all_samples.hyvelR;
     }
-    if (sample_attr_flag[14]){
-      samples["rxvelL"] = all_samples.rxvelL;
-      samples["rxvelR"] = all_samples.rxvelR;
+    if (job.sample_attr_flag[14]){
+      samples["rxvelL"] = job.all_samples.rxvelL;
+      samples["rxvelR"] = job.all_samples.rxvelR;
     }
-    if (sample_attr_flag[15]){
-      samples["ryvelL"] = all_samples.ryvelL;
-      samples["ryvelR"] = all_samples.ryvelR;
+    if (job.sample_attr_flag[15]){
+      samples["ryvelL"] = job.all_samples.ryvelL;
+      samples["ryvelR"] = job.all_samples.ryvelR;
     }
-    if (sample_attr_flag[16]){
-      samples["fgxvelL"] = all_samples.fgxvelL;
-      samples["fgxvelR"] = all_samples.fgxvelR;
+    if (job.sample_attr_flag[16]){
+      samples["fgxvelL"] = job.all_samples.fgxvelL;
+      samples["fgxvelR"] = job.all_samples.fgxvelR;
     }
-    if (sample_attr_flag[17]){
-      samples["fgyvelL"] = all_samples.fgyvelL;
-      samples["fgyvelR"] = all_samples.fgyvelR;
+    if (job.sample_attr_flag[17]){
+      samples["fgyvelL"] = job.all_samples.fgyvelL;
+      samples["fgyvelR"] = job.all_samples.fgyvelR;
     }
-    if (sample_attr_flag[18]){
-      samples["fhxvelL"] = all_samples.fhxvelL;
-      samples["fhxvelR"] = all_samples.fhxvelR;
+    if (job.sample_attr_flag[18]){
+      samples["fhxvelL"] = job.all_samples.fhxvelL;
+      samples["fhxvelR"] = job.all_samples.fhxvelR;
     }
-    if (sample_attr_flag[19]){
-      samples["fhyvelL"] = all_samples.fhyvelL;
-      samples["fhyvelR"] = all_samples.fhyvelR;
+    if (job.sample_attr_flag[19]){
+      samples["fhyvelL"] = job.all_samples.fhyvelL;
+      samples["fhyvelR"] = job.all_samples.fhyvelR;
     }
-    if (sample_attr_flag[20]){
-      samples["frxvelL"] = all_samples.frxvelL;
-      samples["frxvelR"] = all_samples.frxvelR;
+    if (job.sample_attr_flag[20]){
+      samples["frxvelL"] = job.all_samples.frxvelL;
+      samples["frxvelR"] = job.all_samples.frxvelR;
     }
-    if (sample_attr_flag[21]){
-      samples["fryvelL"] = all_samples.fryvelL;
-      samples["fryvelR"] = all_samples.fryvelR;
+    if (job.sample_attr_flag[21]){
+      samples["fryvelL"] = job.all_samples.fryvelL;
+      samples["fryvelR"] = job.all_samples.fryvelR;
     }
-    if (sample_attr_flag[22]){
-      samples["hdata_1"] = all_samples.hdata_1;
-      samples["hdata_2"] = all_samples.hdata_2;
-      samples["hdata_3"] = all_samples.hdata_3;
-      samples["hdata_4"] = all_samples.hdata_4;
-      samples["hdata_5"] = all_samples.hdata_5;
-      samples["hdata_6"] = all_samples.hdata_6;
-      samples["hdata_7"] = all_samples.hdata_7;
-      samples["hdata_8"] = all_samples.hdata_8;
+    if (job.sample_attr_flag[22]){
+      samples["hdata_1"] = job.all_samples.hdata_1;
+      samples["hdata_2"] = job.all_samples.hdata_2;
+      samples["hdata_3"] = job.all_samples.hdata_3;
+      samples["hdata_4"] = job.all_samples.hdata_4;
+      samples["hdata_5"] = job.all_samples.hdata_5;
+      samples["hdata_6"] = job.all_samples.hdata_6;
+      samples["hdata_7"] = job.all_samples.hdata_7;
+      samples["hdata_8"] = job.all_samples.hdata_8;
     }
-    if (sample_attr_flag[23]){
-      samples["flags"] = all_samples.flags;
+    if (job.sample_attr_flag[23]){
+      samples["flags"] = job.all_samples.flags;
     }
-    if (sample_attr_flag[24]){
-      samples["input"] = all_samples.input;
+    if (job.sample_attr_flag[24]){
+      samples["input"] = job.all_samples.input;
     }
-    if (sample_attr_flag[25]){
-      samples["buttons"] = all_samples.buttons;
+    if (job.sample_attr_flag[25]){
+      samples["buttons"] = job.all_samples.buttons;
     }
-    if (sample_attr_flag[26]){
-      samples["htype"] = all_samples.htype;
+    if (job.sample_attr_flag[26]){
+      samples["htype"] = job.all_samples.htype;
     }
-    if (sample_attr_flag[27]){
-      samples["errors"] = all_samples.errors;
+    if (job.sample_attr_flag[27]){
+      samples["errors"] = job.all_samples.errors;
     }
     edf_recording["samples"] = samples;
   }
+  if (job.limit_memory){
+    edf_recording["spilled_bytes"] = job.spill.bytes;
+  }
+
+
+  // releasing decoded data
+  job.all_events = TRIAL_EVENTS();
+  job.all_samples = TRIAL_SAMPLES();
+  job.all_recordings = TRIAL_RECORDINGS();
+  job.trial_summary = TRIAL_SUMMARY();
 
   edf_recording.attr("class") = "edf";
   return (edf_recording);
 }
 
+
+//' @title Internal function that reads EDF file
+//' @description Reads EDF file into a list that contains events, samples, and recordings.
+//' Trials are decoded on a worker thread, while the calling thread shows progress and checks
+//' for user interrupts (independent of verbose). An interrupted import returns trials read so far.
+//' DO NOT call this function directly. Instead, use read_edf function that implements
+//' parameter checks and additional postprocessing.
+//' @param std::string filename, full name of the EDF file
+//' @param int consistency, consistency check control (for the time stamps of the start
+//' and end events, etc). 0, no consistency check. 1, check consistency and report.
+//' 2, check consistency and fix.
+//' @param bool import_events, load/skip loading events.
+//' @param bool import_recordings, load/skip loading recordings.
+//' @param bool import_samples, load/skip loading of samples.
+//' @param bool import_trial_summary, whether to compute per-trial and per-eye summary statistics
+//' from samples and events on the fly. Neither samples nor events need to be imported for that.
+//' @param LogicalVector sample_attr_flag, boolean vector that indicates which sample fields are to be stored
+//' @param double memory_limit, maximal size of sample buffers in bytes. Once exceeded, buffers are spilled
+//' to temporary column files and samples are returned as memory-mapped vectors. Inf, no limit.
+//' @param std::string start_marker_string, event that marks trial start. Defaults to "TRIALID", if empty.
+//' @param std::string end_marker_string, event that marks trial end
+//' @param Nullable<NumericMatrix> trial_index, trial headers resolved from a message index (see index_trials).
+//' If specified, trial navigation of the EDF API is not used. Instead, the file is read sequentially
+//' once and records are assigned to trials by their time. NULL, use EDF API trial navigation.
+//' @param Nullable<NumericMatrix> recording_blocks, headers of recording blocks (same layout as trial headers,
+//' endtime is the end of the part of the file that belongs to the block). If specified together with trial_index,
+//' records are read block by block, including those between trials (trial 0), and samples get block column. NULL, read trials.
+//' @param Nullable<List> sample_filter, filter specification created by sample_filter(). Listed sample
+//' columns are filtered at the end of every trial, before they are stored (or spilled to disk). NULL, no filtering.
+//' @param verbose, whether to show progressbar and report number of trials
+//' @export
+//' @keywords internal
+//' @return List, contents of the EDF file. Please see read_edf for details.
+//[[Rcpp::export]]
+List read_edf_file(std::string filename,
+                   int consistency,
+                   bool import_events,
+                   bool import_recordings,
+                   bool import_samples,
+                   bool import_trial_summary,
+                   LogicalVector sample_attr_flag,
+                   double memory_limit,
+                   std::string start_marker_string,
+                   std::string end_marker_string,
+                   Nullable<NumericMatrix> trial_index,
+                   Nullable<NumericMatrix> recording_blocks,
+                   Nullable<List> sample_filter,
+                   bool verbose){
+  // handle owns the import, so that an error while collecting the recording still joins the worker thread,
+  // releases the EDF API, and removes spilled samples once the handle is garbage collected
+  XPtr <EDF_IMPORT, PreserveStorage, finalize_edf_import, true> job(
+    prepare_edf_import(filename, consistency, import_events, import_recordings, import_samples, import_trial_summary,
+                       sample_attr_flag, memory_limit, start_marker_string, end_marker_string, trial_index, recording_blocks, sample_filter));
+  job->worker = std::thread(import_edf_trials, job.get());
+
+  // waiting for the trial count, interrupt cancels the import
+  while (job->status == IMPORT_RUNNING && !job->trials_counted){
+    if (!wait_for_edf_import()) job->cancel_requested = true;
+  }
+  if (verbose){
+    ::Rprintf("Trials count: %d\n", (unsigned int)job->total_trials);
+  }
+
+  // showing progress of the worker thread
+  Progress trial_counter(job->total_trials, verbose);
+  unsigned int reported_trials = 0;
+  while (job->status == IMPORT_RUNNING){
+    if (!wait_for_edf_import()) job->cancel_requested = true;
+    const unsigned int trials_done = job->trials_done;
+    trial_counter.increment(trials_done - reported_trials);
+    reported_trials = trials_done;
+  }
+  job->worker.join();
+
+  if (job->status == IMPORT_FAILED){
+    const std::string error = job->error;
+    job.release();
+    ::Rf_error("%s", error.c_str());
+  }
+  List edf_recording = collect_edf_recording(*job);
+  job.release();
+  return edf_recording;
+}
+
+
+//' @title Starts import of EDF file on a worker thread
+//' @description Prepares the import on the calling thread and decodes trials on a worker thread,
+//' so that the R session is not blocked. See read_edf_file for parameters.
+//' DO NOT call this function directly. Instead, use read_edf_async function.
+//' @export
+//' @keywords internal
+//' @return external pointer to the import, see edf_import_progress, cancel_edf_import, and collect_edf_import.
+//[[Rcpp::export]]
+SEXP start_edf_import(std::string filename,
+                      int consistency,
+                      bool import_events,
+                      bool import_recordings,
+                      bool import_samples,
+                      bool import_trial_summary,
+                      LogicalVector sample_attr_flag,
+                      double memory_limit,
+                      std::string start_marker_string,
+                      std::string end_marker_string,
+                      Nullable<NumericMatrix> trial_index,
+                      Nullable<NumericMatrix> recording_blocks,
+                      Nullable<List> sample_filter){
+  XPtr <EDF_IMPORT, PreserveStorage, finalize_edf_import, true> job(
+    prepare_edf_import(filename, consistency, import_events, import_recordings, import_samples, import_trial_summary,
+                       sample_attr_flag, memory_limit, start_marker_string, end_marker_string, trial_index, recording_blocks, sample_filter));
+  job->worker = std::thread(import_edf_trials, job.get());
+  return job;
+}
+
+//' @title Returns import from its handle
+//' @param SEXP handle, external pointer created by start_edf_import
+//' @return EDF_IMPORT*
+//' @keywords internal
+EDF_IMPORT* edf_import_from_handle(SEXP handle){
+  if (TYPEOF(handle) != EXTPTRSXP || R_ExternalPtrAddr(handle) == NULL) ::Rf_error("Invalid or finalized import handle.");
+  return (EDF_IMPORT*)R_ExternalPtrAddr(handle);
+}
+
+//' @title Reports progress of an import
+//' @description Can be called at any time, does not wait for the worker thread.
+//' DO NOT call this function directly. Instead, use import_progress function.
+//' @param SEXP handle, external pointer created by start_edf_import
+//' @export
+//' @keywords internal
+//' @return List with status ("running", "done", "cancelled", or "failed"), total number of trials
+//' (NA, while trials are being counted), number of trials done, and number of samples and bytes decoded.
+//[[Rcpp::export]]
+List edf_import_progress(SEXP handle){
+  EDF_IMPORT* job = edf_import_from_handle(handle);
+  const char* status_labels[] = {"running", "done", "cancelled", "failed"};
+  return List::create(_["status"] = status_labels[job->status],
+                      _["trials"] = job->trials_counted ? (double)job->total_trials : NA_REAL,
+                      _["trials_done"] = (double)job->trials_done,
+                      _["samples"] = (double)job->samples_decoded,
+                      _["bytes"] = (double)job->bytes_decoded,
+                      _["collected"] = job->collected);
+}
+
+//' @title Cancels an import
+//' @description Asks the worker thread to stop and waits until it closes the file.
+//' Trials decoded so far can still be collected.
+//' DO NOT call this function directly. Instead, use cancel_import function.
+//' @param SEXP handle, external pointer created by start_edf_import
+//' @export
+//' @keywords internal
+//' @return bool, whether the import was running.
+//[[Rcpp::export]]
+bool cancel_edf_import(SEXP handle){
+  EDF_IMPORT* job = edf_import_from_handle(handle);
+  const bool was_running = job->status == IMPORT_RUNNING;
+  job->cancel_requested = true;
+  if (job->worker.joinable()) job->worker.join();
+  return was_running;
+}
+
+//' @title Collects data of an import
+//' @description Waits for the worker thread to finish (a user interrupt stops waiting but not the import)
+//' and converts decoded data into R objects. Data can be collected only once.
+//' DO NOT call this function directly. Instead, use collect_import function.
+//' @param SEXP handle, external pointer created by start_edf_import
+//' @export
+//' @keywords internal
+//' @return List, contents of the EDF file. Please see read_edf for details.
+//[[Rcpp::export]]
+List collect_edf_import(SEXP handle){
+  EDF_IMPORT* job = edf_import_from_handle(handle);
+  if (job->collected) ::Rf_error("Import was already collected.");
+  while (job->status == IMPORT_RUNNING){
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    Rcpp::checkUserInterrupt();
+  }
+  if (job->worker.joinable()) job->worker.join();
+  if (job->status == IMPORT_FAILED){
+    job->collected = true;
+    remove_spilled_columns(job->spill);
+    ::Rf_error("%s", job->error.c_str());
+  }
+  return collect_edf_recording(*job);
+}
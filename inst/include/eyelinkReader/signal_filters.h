@@ -0,0 +1,250 @@
+#ifndef EYELINKREADER_SIGNAL_FILTERS_H
+#define EYELINKREADER_SIGNAL_FILTERS_H
+
+// Filters for sample columns that are shared by filter_samples() and the import via
+// read_edf(sample_filter = ). Kernels do not use R API, so that they can run in parallel.
+//
+// A trial is split into segments of consecutive valid (non-NaN) samples, a new segment
+// starts after a gap in time stamps (more than 1.5 sampling intervals). Every segment
+// is filtered separately and NaN samples are kept as is, so that filters never bridge
+// blinks, lost data, or trial boundaries.
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// supported filters
+enum SIGNAL_FILTER_TYPE {FILTER_SAVITZKY_GOLAY = 0, FILTER_MEDIAN = 1, FILTER_BUTTERWORTH = 2};
+
+typedef struct SIGNAL_FILTER {
+  int type;
+  int window;      // Savitzky-Golay and median, odd number of samples
+  int order;       // polynomial order for Savitzky-Golay, filter order for Butterworth
+  int derivative;  // Savitzky-Golay only, per second
+  double cutoff;   // Butterworth only, in Hz
+} SIGNAL_FILTER;
+
+// ------------------ Savitzky-Golay ------------------
+
+// Coefficients that fit polynomial of the given order to m points and evaluate its
+// derivative at point t (0 <= t < m). Spacing between points is one.
+inline std::vector <double> savitzky_golay_coefficients(int m, int t, int order, int derivative){
+  const int terms = order + 1;
+  std::vector <double> coefficients(m, 0);
+  if (derivative > order) return coefficients;
+
+  // normal equations (A'A) y = e_derivative, A[i][k] = (i - t)^k
+  std::vector <double> gram(terms * (terms + 1), 0);
+  for(int iRow = 0; iRow < terms; iRow++){
+    for(int iColumn = 0; iColumn < terms; iColumn++){
+      double sum = 0;
+      for(int i = 0; i < m; i++) sum += std::pow((double)(i - t), iRow + iColumn);
+      gram[iRow * (terms + 1) + iColumn] = sum;
+    }
+    gram[iRow * (terms + 1) + terms] = iRow == derivative ? 1 : 0;
+  }
+
+  // Gaussian elimination with partial pivoting
+  for(int iPivot = 0; iPivot < terms; iPivot++){
+    int best = iPivot;
+    for(int iRow = iPivot + 1; iRow < terms; iRow++){
+      if (std::fabs(gram[iRow * (terms + 1) + iPivot]) > std::fabs(gram[best * (terms + 1) + iPivot])) best = iRow;
+    }
+    for(int iColumn = 0; iColumn <= terms; iColumn++) std::swap(gram[iPivot * (terms + 1) + iColumn], gram[best * (terms + 1) + iColumn]);
+    const double pivot = gram[iPivot * (terms + 1) + iPivot];
+    for(int iRow = 0; iRow < terms; iRow++){
+      if (iRow == iPivot) continue;
+      const double factor = gram[iRow * (terms + 1) + iPivot] / pivot;
+      for(int iColumn = iPivot; iColumn <= terms; iColumn++) gram[iRow * (terms + 1) + iColumn] -= factor * gram[iPivot * (terms + 1) + iColumn];
+    }
+  }
+
+  double factorial = 1;
+  for(int k = 2; k <= derivative; k++) factorial *= k;
+  for(int i = 0; i < m; i++){
+    double sum = 0;
+    for(int k = 0; k < terms; k++) sum += gram[k * (terms + 1) + terms] / gram[k * (terms + 1) + k] * std::pow((double)(i - t), k);
+    coefficients[i] = factorial * sum;
+  }
+  return coefficients;
+}
+
+// Coefficients for every evaluation point of windows of every size, computed on demand.
+typedef struct SAVITZKY_GOLAY_CACHE {
+  std::vector <std::vector <std::vector <double> > > coefficients; // [window size][evaluation point]
+
+  const std::vector <std::vector <double> > &get(int m, int order, int derivative){
+    if ((int)coefficients.size() <= m) coefficients.resize(m + 1);
+    if (coefficients[m].empty()){
+      for(int t = 0; t < m; t++) coefficients[m].push_back(savitzky_golay_coefficients(m, t, order, derivative));
+    }
+    return coefficients[m];
+  }
+} SAVITZKY_GOLAY_CACHE;
+
+// Smooths (or differentiates) a segment. Samples closer than half a window to segment ends
+// are evaluated from the polynomial fitted to the first (last) window. Segments shorter
+// than the window are fitted as a whole with the order reduced, if necessary.
+inline void savitzky_golay_segment(const double* x, size_t n, double* out, const SIGNAL_FILTER &filter, double dt, SAVITZKY_GOLAY_CACHE &cache){
+  const double scale = filter.derivative == 0 ? 1 : std::pow(dt / 1000.0, -filter.derivative);
+  const int m = std::min((int)n, filter.window);
+  const int order = std::min(filter.order, m - 1);
+  if (filter.derivative > order){
+    for(size_t i = 0; i < n; i++) out[i] = NAN;
+    return;
+  }
+
+  const std::vector <std::vector <double> > &coefficients = cache.get(m, order, filter.derivative);
+  const size_t half = m / 2;
+  for(size_t i = 0; i < n; i++){
+    const size_t start = std::min(i >= half ? i - half : 0, n - m);
+    const double* weights = coefficients[i - start].data();
+    double sum = 0;
+    for(int k = 0; k < m; k++) sum += weights[k] * x[start + k];
+    out[i] = sum * scale;
+  }
+}
+
+// ------------------ median ------------------
+
+// Running median, the window is truncated at segment ends.
+inline void median_segment(const double* x, size_t n, double* out, const SIGNAL_FILTER &filter){
+  const size_t half = filter.window / 2;
+  std::vector <double> buffer;
+  buffer.reserve(filter.window);
+  for(size_t i = 0; i < n; i++){
+    const size_t first = i >= half ? i - half : 0;
+    const size_t last = std::min(n - 1, i + half);
+    buffer.assign(x + first, x + last + 1);
+    const size_t middle = buffer.size() / 2;
+    std::nth_element(buffer.begin(), buffer.begin() + middle, buffer.end());
+    double median = buffer[middle];
+    if (buffer.size() % 2 == 0) median = (median + *std::max_element(buffer.begin(), buffer.begin() + middle)) / 2;
+    out[i] = median;
+  }
+}
+
+// ------------------ Butterworth ------------------
+
+// second order section in the transposed direct form II, a0 = 1
+typedef struct BIQUAD {
+  double b0, b1, b2, a1, a2;
+} BIQUAD;
+
+// Low-pass Butterworth filter as second order sections via bilinear transform with prewarping.
+// Returns no sections, if the cutoff is not below Nyquist frequency.
+inline std::vector <BIQUAD> butterworth_sections(int order, double cutoff, double sampling_rate){
+  std::vector <BIQUAD> sections;
+  if (!(cutoff > 0 && cutoff < sampling_rate / 2) || order < 1) return sections;
+  const double pi = 3.14159265358979323846;
+  const double warped = 2 * sampling_rate * std::tan(pi * cutoff / sampling_rate);
+
+  for(int k = 0; k < order / 2; k++){
+    const std::complex <double> pole = warped * std::exp(std::complex <double>(0, pi * (2 * k + order + 1) / (2.0 * order)));
+    const std::complex <double> z = (2 * sampling_rate + pole) / (2 * sampling_rate - pole);
+    BIQUAD section;
+    section.a1 = -2 * z.real();
+    section.a2 = std::norm(z);
+    const double gain = (1 + section.a1 + section.a2) / 4;
+    section.b0 = gain;
+    section.b1 = 2 * gain;
+    section.b2 = gain;
+    sections.push_back(section);
+  }
+  if (order % 2 == 1){
+    const double pole = -warped;
+    const double z = (2 * sampling_rate + pole) / (2 * sampling_rate - pole);
+    BIQUAD section;
+    section.a1 = -z;
+    section.a2 = 0;
+    section.b0 = (1 - z) / 2;
+    section.b1 = (1 - z) / 2;
+    section.b2 = 0;
+    sections.push_back(section);
+  }
+  return sections;
+}
+
+// Filters the signal in place, initial state corresponds to a constant signal equal to the first value.
+inline void biquad_cascade(std::vector <double> &signal, const std::vector <BIQUAD> &sections){
+  for(size_t iSection = 0; iSection < sections.size(); iSection++){
+    const BIQUAD &s = sections[iSection];
+    const double x0 = signal[0];
+    const double y0 = x0 * (s.b0 + s.b1 + s.b2) / (1 + s.a1 + s.a2);
+    double z2 = s.b2 * x0 - s.a2 * y0;
+    double z1 = s.b1 * x0 - s.a1 * y0 + z2;
+    for(size_t i = 0; i < signal.size(); i++){
+      const double x = signal[i];
+      const double y = s.b0 * x + z1;
+      z1 = s.b1 * x - s.a1 * y + z2;
+      z2 = s.b2 * x - s.a2 * y;
+      signal[i] = y;
+    }
+  }
+}
+
+// Zero-phase forward-backward filtering of a segment with odd reflection at both ends.
+inline void butterworth_segment(const double* x, size_t n, double* out, const std::vector <BIQUAD> &sections){
+  const size_t pad = std::min((size_t)(3 * (2 * sections.size() + 1)), n - 1);
+  std::vector <double> signal(n + 2 * pad);
+  for(size_t j = 0; j < pad; j++){
+    signal[pad - 1 - j] = 2 * x[0] - x[j + 1];
+    signal[pad + n + j] = 2 * x[n - 1] - x[n - 2 - j];
+  }
+  std::copy(x, x + n, signal.begin() + pad);
+
+  biquad_cascade(signal, sections);
+  std::reverse(signal.begin(), signal.end());
+  biquad_cascade(signal, sections);
+  std::reverse(signal.begin(), signal.end());
+  std::copy(signal.begin() + pad, signal.begin() + pad + n, out);
+}
+
+// ------------------ trials ------------------
+
+// Filters samples of a single trial. Time stamps (in milliseconds) are optional and are used to
+// detect gaps and the sampling interval, dt is used otherwise. Returns false, if the filter is not
+// applicable (cutoff is not below Nyquist frequency), in which case output is NaN.
+inline bool filter_trial(const double* x, const double* time, size_t n, double dt, const SIGNAL_FILTER &filter, double* out){
+  if (time != NULL){
+    double min_dt = INFINITY;
+    for(size_t i = 1; i < n; i++){
+      const double step = time[i] - time[i - 1];
+      if (step > 0 && step < min_dt) min_dt = step;
+    }
+    if (std::isfinite(min_dt)) dt = min_dt;
+  }
+
+  SAVITZKY_GOLAY_CACHE cache;
+  std::vector <BIQUAD> sections;
+  if (filter.type == FILTER_BUTTERWORTH){
+    sections = butterworth_sections(filter.order, filter.cutoff, 1000.0 / dt);
+    if (sections.empty()){
+      for(size_t i = 0; i < n; i++) out[i] = NAN;
+      return false;
+    }
+  }
+
+  size_t i = 0;
+  while (i < n){
+    if (std::isnan(x[i])){
+      out[i] = NAN;
+      i++;
+      continue;
+    }
+    size_t end = i + 1;
+    while (end < n && !std::isnan(x[end]) && (time == NULL || time[end] - time[end - 1] <= 1.5 * dt)) end++;
+
+    switch(filter.type){
+      case FILTER_SAVITZKY_GOLAY: savitzky_golay_segment(x + i, end - i, out + i, filter, dt, cache); break;
+      case FILTER_MEDIAN: median_segment(x + i, end - i, out + i, filter); break;
+      case FILTER_BUTTERWORTH: butterworth_segment(x + i, end - i, out + i, sections); break;
+    }
+    i = end;
+  }
+  return true;
+}
+
+#endif
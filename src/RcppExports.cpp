@@ -10,6 +10,109 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// accumulate_heatmap
+NumericMatrix accumulate_heatmap(NumericMatrix grid, NumericVector x, NumericVector y, NumericVector weight, NumericVector bounds, double bin_size);
+RcppExport SEXP _eyelinkReader_accumulate_heatmap(SEXP gridSEXP, SEXP xSEXP, SEXP ySEXP, SEXP weightSEXP, SEXP boundsSEXP, SEXP bin_sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type grid(gridSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type weight(weightSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type bounds(boundsSEXP);
+    Rcpp::traits::input_parameter< double >::type bin_size(bin_sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(accumulate_heatmap(grid, x, y, weight, bounds, bin_size));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bin_points
+DataFrame bin_points(NumericVector x, NumericVector y, NumericVector value, NumericVector bounds, int resolution);
+RcppExport SEXP _eyelinkReader_bin_points(SEXP xSEXP, SEXP ySEXP, SEXP valueSEXP, SEXP boundsSEXP, SEXP resolutionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type value(valueSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type bounds(boundsSEXP);
+    Rcpp::traits::input_parameter< int >::type resolution(resolutionSEXP);
+    rcpp_result_gen = Rcpp::wrap(bin_points(x, y, value, bounds, resolution));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bin_segments
+DataFrame bin_segments(NumericVector x, NumericVector y, NumericVector xend, NumericVector yend, NumericVector value, NumericVector bounds, int resolution);
+RcppExport SEXP _eyelinkReader_bin_segments(SEXP xSEXP, SEXP ySEXP, SEXP xendSEXP, SEXP yendSEXP, SEXP valueSEXP, SEXP boundsSEXP, SEXP resolutionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type xend(xendSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type yend(yendSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type value(valueSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type bounds(boundsSEXP);
+    Rcpp::traits::input_parameter< int >::type resolution(resolutionSEXP);
+    rcpp_result_gen = Rcpp::wrap(bin_segments(x, y, xend, yend, value, bounds, resolution));
+    return rcpp_result_gen;
+END_RCPP
+}
+// bind_tables
+List bind_tables(List tables, CharacterVector sources, std::string source_column);
+RcppExport SEXP _eyelinkReader_bind_tables(SEXP tablesSEXP, SEXP sourcesSEXP, SEXP source_columnSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type tables(tablesSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type sources(sourcesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type source_column(source_columnSEXP);
+    rcpp_result_gen = Rcpp::wrap(bind_tables(tables, sources, source_column));
+    return rcpp_result_gen;
+END_RCPP
+}
+// cancel_edf_import
+bool cancel_edf_import(SEXP handle);
+RcppExport SEXP _eyelinkReader_cancel_edf_import(SEXP handleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle(handleSEXP);
+    rcpp_result_gen = Rcpp::wrap(cancel_edf_import(handle));
+    return rcpp_result_gen;
+END_RCPP
+}
+// collect_edf_import
+List collect_edf_import(SEXP handle);
+RcppExport SEXP _eyelinkReader_collect_edf_import(SEXP handleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle(handleSEXP);
+    rcpp_result_gen = Rcpp::wrap(collect_edf_import(handle));
+    return rcpp_result_gen;
+END_RCPP
+}
+// compare_scanpath_pairs
+List compare_scanpath_pairs(IntegerVector first, IntegerVector aoi, NumericVector x, NumericVector y, NumericVector duration, bool levenshtein, bool multimatch, double diagonal, bool collapse, int tile);
+RcppExport SEXP _eyelinkReader_compare_scanpath_pairs(SEXP firstSEXP, SEXP aoiSEXP, SEXP xSEXP, SEXP ySEXP, SEXP durationSEXP, SEXP levenshteinSEXP, SEXP multimatchSEXP, SEXP diagonalSEXP, SEXP collapseSEXP, SEXP tileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< IntegerVector >::type first(firstSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type aoi(aoiSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type duration(durationSEXP);
+    Rcpp::traits::input_parameter< bool >::type levenshtein(levenshteinSEXP);
+    Rcpp::traits::input_parameter< bool >::type multimatch(multimatchSEXP);
+    Rcpp::traits::input_parameter< double >::type diagonal(diagonalSEXP);
+    Rcpp::traits::input_parameter< bool >::type collapse(collapseSEXP);
+    Rcpp::traits::input_parameter< int >::type tile(tileSEXP);
+    rcpp_result_gen = Rcpp::wrap(compare_scanpath_pairs(first, aoi, x, y, duration, levenshtein, multimatch, diagonal, collapse, tile));
+    return rcpp_result_gen;
+END_RCPP
+}
 // compiled_library_status
 bool compiled_library_status();
 RcppExport SEXP _eyelinkReader_compiled_library_status() {
@@ -31,9 +134,189 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// edf_import_progress
+List edf_import_progress(SEXP handle);
+RcppExport SEXP _eyelinkReader_edf_import_progress(SEXP handleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle(handleSEXP);
+    rcpp_result_gen = Rcpp::wrap(edf_import_progress(handle));
+    return rcpp_result_gen;
+END_RCPP
+}
+// epoch_sample_columns
+SEXP epoch_sample_columns(List columns, NumericVector trial, NumericVector time, NumericVector epoch_trial, NumericVector epoch_anchor, double start, double step, int points, bool single_precision, bool row_major);
+RcppExport SEXP _eyelinkReader_epoch_sample_columns(SEXP columnsSEXP, SEXP trialSEXP, SEXP timeSEXP, SEXP epoch_trialSEXP, SEXP epoch_anchorSEXP, SEXP startSEXP, SEXP stepSEXP, SEXP pointsSEXP, SEXP single_precisionSEXP, SEXP row_majorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type columns(columnsSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type trial(trialSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type time(timeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type epoch_trial(epoch_trialSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type epoch_anchor(epoch_anchorSEXP);
+    Rcpp::traits::input_parameter< double >::type start(startSEXP);
+    Rcpp::traits::input_parameter< double >::type step(stepSEXP);
+    Rcpp::traits::input_parameter< int >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< bool >::type single_precision(single_precisionSEXP);
+    Rcpp::traits::input_parameter< bool >::type row_major(row_majorSEXP);
+    rcpp_result_gen = Rcpp::wrap(epoch_sample_columns(columns, trial, time, epoch_trial, epoch_anchor, start, step, points, single_precision, row_major));
+    return rcpp_result_gen;
+END_RCPP
+}
+// filter_sample_columns
+List filter_sample_columns(List columns, NumericVector trial, NumericVector time, int type, int window, int order, int derivative, double cutoff);
+RcppExport SEXP _eyelinkReader_filter_sample_columns(SEXP columnsSEXP, SEXP trialSEXP, SEXP timeSEXP, SEXP typeSEXP, SEXP windowSEXP, SEXP orderSEXP, SEXP derivativeSEXP, SEXP cutoffSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type columns(columnsSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type trial(trialSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type time(timeSEXP);
+    Rcpp::traits::input_parameter< int >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< int >::type window(windowSEXP);
+    Rcpp::traits::input_parameter< int >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< int >::type derivative(derivativeSEXP);
+    Rcpp::traits::input_parameter< double >::type cutoff(cutoffSEXP);
+    rcpp_result_gen = Rcpp::wrap(filter_sample_columns(columns, trial, time, type, window, order, derivative, cutoff));
+    return rcpp_result_gen;
+END_RCPP
+}
+// gaussian_blur
+NumericMatrix gaussian_blur(NumericMatrix grid, double sigma);
+RcppExport SEXP _eyelinkReader_gaussian_blur(SEXP gridSEXP, SEXP sigmaSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type grid(gridSEXP);
+    Rcpp::traits::input_parameter< double >::type sigma(sigmaSEXP);
+    rcpp_result_gen = Rcpp::wrap(gaussian_blur(grid, sigma));
+    return rcpp_result_gen;
+END_RCPP
+}
+// map_column_file
+SEXP map_column_file(std::string filename, std::string type, double length, Nullable<CharacterVector> levels);
+RcppExport SEXP _eyelinkReader_map_column_file(SEXP filenameSEXP, SEXP typeSEXP, SEXP lengthSEXP, SEXP levelsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type filename(filenameSEXP);
+    Rcpp::traits::input_parameter< std::string >::type type(typeSEXP);
+    Rcpp::traits::input_parameter< double >::type length(lengthSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type levels(levelsSEXP);
+    rcpp_result_gen = Rcpp::wrap(map_column_file(filename, type, length, levels));
+    return rcpp_result_gen;
+END_RCPP
+}
+// match_samples_to_events
+DataFrame match_samples_to_events(NumericVector sample_trial, NumericVector sample_time, NumericVector event_trial, IntegerVector event_eye, IntegerVector event_kind, IntegerVector event_id, NumericVector event_sttime, NumericVector event_entime);
+RcppExport SEXP _eyelinkReader_match_samples_to_events(SEXP sample_trialSEXP, SEXP sample_timeSEXP, SEXP event_trialSEXP, SEXP event_eyeSEXP, SEXP event_kindSEXP, SEXP event_idSEXP, SEXP event_sttimeSEXP, SEXP event_entimeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type sample_trial(sample_trialSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type sample_time(sample_timeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type event_trial(event_trialSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type event_eye(event_eyeSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type event_kind(event_kindSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type event_id(event_idSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type event_sttime(event_sttimeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type event_entime(event_entimeSEXP);
+    rcpp_result_gen = Rcpp::wrap(match_samples_to_events(sample_trial, sample_time, event_trial, event_eye, event_kind, event_id, event_sttime, event_entime));
+    return rcpp_result_gen;
+END_RCPP
+}
+// parse_message_offsets
+List parse_message_offsets(CharacterVector message, NumericVector sttime);
+RcppExport SEXP _eyelinkReader_parse_message_offsets(SEXP messageSEXP, SEXP sttimeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< CharacterVector >::type message(messageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type sttime(sttimeSEXP);
+    rcpp_result_gen = Rcpp::wrap(parse_message_offsets(message, sttime));
+    return rcpp_result_gen;
+END_RCPP
+}
+// parse_messages
+List parse_messages(DataFrame events, List specs);
+RcppExport SEXP _eyelinkReader_parse_messages(SEXP eventsSEXP, SEXP specsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type events(eventsSEXP);
+    Rcpp::traits::input_parameter< List >::type specs(specsSEXP);
+    rcpp_result_gen = Rcpp::wrap(parse_messages(events, specs));
+    return rcpp_result_gen;
+END_RCPP
+}
+// parse_trial_variables
+DataFrame parse_trial_variables(DataFrame events);
+RcppExport SEXP _eyelinkReader_parse_trial_variables(SEXP eventsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type events(eventsSEXP);
+    rcpp_result_gen = Rcpp::wrap(parse_trial_variables(events));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pivot_trial_variables
+DataFrame pivot_trial_variables(DataFrame variables);
+RcppExport SEXP _eyelinkReader_pivot_trial_variables(SEXP variablesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< DataFrame >::type variables(variablesSEXP);
+    rcpp_result_gen = Rcpp::wrap(pivot_trial_variables(variables));
+    return rcpp_result_gen;
+END_RCPP
+}
+// preprocess_pupil_columns
+List preprocess_pupil_columns(List columns, IntegerVector column_eye, NumericVector trial, NumericVector time, NumericVector blink_trial, IntegerVector blink_eye, NumericVector blink_sttime, NumericVector blink_entime, double pad_before, double pad_after, bool cubic, double max_gap, NumericVector anchor_trial, NumericVector anchor_time, double baseline_start, double baseline_end, int baseline_method);
+RcppExport SEXP _eyelinkReader_preprocess_pupil_columns(SEXP columnsSEXP, SEXP column_eyeSEXP, SEXP trialSEXP, SEXP timeSEXP, SEXP blink_trialSEXP, SEXP blink_eyeSEXP, SEXP blink_sttimeSEXP, SEXP blink_entimeSEXP, SEXP pad_beforeSEXP, SEXP pad_afterSEXP, SEXP cubicSEXP, SEXP max_gapSEXP, SEXP anchor_trialSEXP, SEXP anchor_timeSEXP, SEXP baseline_startSEXP, SEXP baseline_endSEXP, SEXP baseline_methodSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type columns(columnsSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type column_eye(column_eyeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type trial(trialSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type time(timeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type blink_trial(blink_trialSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type blink_eye(blink_eyeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type blink_sttime(blink_sttimeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type blink_entime(blink_entimeSEXP);
+    Rcpp::traits::input_parameter< double >::type pad_before(pad_beforeSEXP);
+    Rcpp::traits::input_parameter< double >::type pad_after(pad_afterSEXP);
+    Rcpp::traits::input_parameter< bool >::type cubic(cubicSEXP);
+    Rcpp::traits::input_parameter< double >::type max_gap(max_gapSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type anchor_trial(anchor_trialSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type anchor_time(anchor_timeSEXP);
+    Rcpp::traits::input_parameter< double >::type baseline_start(baseline_startSEXP);
+    Rcpp::traits::input_parameter< double >::type baseline_end(baseline_endSEXP);
+    Rcpp::traits::input_parameter< int >::type baseline_method(baseline_methodSEXP);
+    rcpp_result_gen = Rcpp::wrap(preprocess_pupil_columns(columns, column_eye, trial, time, blink_trial, blink_eye, blink_sttime, blink_entime, pad_before, pad_after, cubic, max_gap, anchor_trial, anchor_time, baseline_start, baseline_end, baseline_method));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_column_store
+List read_column_store(std::string filename, Nullable<CharacterVector> tables, Nullable<CharacterVector> columns, Nullable<NumericVector> trials);
+RcppExport SEXP _eyelinkReader_read_column_store(SEXP filenameSEXP, SEXP tablesSEXP, SEXP columnsSEXP, SEXP trialsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type filename(filenameSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type tables(tablesSEXP);
+    Rcpp::traits::input_parameter< Nullable<CharacterVector> >::type columns(columnsSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type trials(trialsSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_column_store(filename, tables, columns, trials));
+    return rcpp_result_gen;
+END_RCPP
+}
 // read_edf_file
-List read_edf_file(std::string filename, int consistency, bool import_events, bool import_recordings, bool import_samples, LogicalVector sample_attr_flag, std::string start_marker_string, std::string end_marker_string, bool verbose);
-RcppExport SEXP _eyelinkReader_read_edf_file(SEXP filenameSEXP, SEXP consistencySEXP, SEXP import_eventsSEXP, SEXP import_recordingsSEXP, SEXP import_samplesSEXP, SEXP sample_attr_flagSEXP, SEXP start_marker_stringSEXP, SEXP end_marker_stringSEXP, SEXP verboseSEXP) {
+List read_edf_file(std::string filename, int consistency, bool import_events, bool import_recordings, bool import_samples, bool import_trial_summary, LogicalVector sample_attr_flag, double memory_limit, std::string start_marker_string, std::string end_marker_string, Nullable<NumericMatrix> trial_index, Nullable<NumericMatrix> recording_blocks, Nullable<List> sample_filter, bool verbose);
+RcppExport SEXP _eyelinkReader_read_edf_file(SEXP filenameSEXP, SEXP consistencySEXP, SEXP import_eventsSEXP, SEXP import_recordingsSEXP, SEXP import_samplesSEXP, SEXP import_trial_summarySEXP, SEXP sample_attr_flagSEXP, SEXP memory_limitSEXP, SEXP start_marker_stringSEXP, SEXP end_marker_stringSEXP, SEXP trial_indexSEXP, SEXP recording_blocksSEXP, SEXP sample_filterSEXP, SEXP verboseSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -42,11 +325,28 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type import_events(import_eventsSEXP);
     Rcpp::traits::input_parameter< bool >::type import_recordings(import_recordingsSEXP);
     Rcpp::traits::input_parameter< bool >::type import_samples(import_samplesSEXP);
+    Rcpp::traits::input_parameter< bool >::type import_trial_summary(import_trial_summarySEXP);
     Rcpp::traits::input_parameter< LogicalVector >::type sample_attr_flag(sample_attr_flagSEXP);
+    Rcpp::traits::input_parameter< double >::type memory_limit(memory_limitSEXP);
     Rcpp::traits::input_parameter< std::string >::type start_marker_string(start_marker_stringSEXP);
     Rcpp::traits::input_parameter< std::string >::type end_marker_string(end_marker_stringSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericMatrix> >::type trial_index(trial_indexSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericMatrix> >::type recording_blocks(recording_blocksSEXP);
+    Rcpp::traits::input_parameter< Nullable<List> >::type sample_filter(sample_filterSEXP);
     Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
-    rcpp_result_gen = Rcpp::wrap(read_edf_file(filename, consistency, import_events, import_recordings, import_samples, sample_attr_flag, start_marker_string, end_marker_string, verbose));
+    rcpp_result_gen = Rcpp::wrap(read_edf_file(filename, consistency, import_events, import_recordings, import_samples, import_trial_summary, sample_attr_flag, memory_limit, start_marker_string, end_marker_string, trial_index, recording_blocks, sample_filter, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_message_index
+List read_message_index(std::string filename, int consistency);
+RcppExport SEXP _eyelinkReader_read_message_index(SEXP filenameSEXP, SEXP consistencySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type filename(filenameSEXP);
+    Rcpp::traits::input_parameter< int >::type consistency(consistencySEXP);
+    rcpp_result_gen = Rcpp::wrap(read_message_index(filename, consistency));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -61,16 +361,124 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// resolve_trial_boundaries
+DataFrame resolve_trial_boundaries(NumericVector message_time, CharacterVector message, NumericVector recording_time, IntegerVector recording_state, std::string start_marker, std::string end_marker);
+RcppExport SEXP _eyelinkReader_resolve_trial_boundaries(SEXP message_timeSEXP, SEXP messageSEXP, SEXP recording_timeSEXP, SEXP recording_stateSEXP, SEXP start_markerSEXP, SEXP end_markerSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type message_time(message_timeSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type message(messageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type recording_time(recording_timeSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type recording_state(recording_stateSEXP);
+    Rcpp::traits::input_parameter< std::string >::type start_marker(start_markerSEXP);
+    Rcpp::traits::input_parameter< std::string >::type end_marker(end_markerSEXP);
+    rcpp_result_gen = Rcpp::wrap(resolve_trial_boundaries(message_time, message, recording_time, recording_state, start_marker, end_marker));
+    return rcpp_result_gen;
+END_RCPP
+}
+// scan_trial_quality
+DataFrame scan_trial_quality(std::string filename, int consistency, NumericMatrix trial_headers, double max_gap);
+RcppExport SEXP _eyelinkReader_scan_trial_quality(SEXP filenameSEXP, SEXP consistencySEXP, SEXP trial_headersSEXP, SEXP max_gapSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type filename(filenameSEXP);
+    Rcpp::traits::input_parameter< int >::type consistency(consistencySEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type trial_headers(trial_headersSEXP);
+    Rcpp::traits::input_parameter< double >::type max_gap(max_gapSEXP);
+    rcpp_result_gen = Rcpp::wrap(scan_trial_quality(filename, consistency, trial_headers, max_gap));
+    return rcpp_result_gen;
+END_RCPP
+}
+// simplify_polyline
+LogicalVector simplify_polyline(NumericVector x, NumericVector y, NumericVector group, double tolerance);
+RcppExport SEXP _eyelinkReader_simplify_polyline(SEXP xSEXP, SEXP ySEXP, SEXP groupSEXP, SEXP toleranceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type group(groupSEXP);
+    Rcpp::traits::input_parameter< double >::type tolerance(toleranceSEXP);
+    rcpp_result_gen = Rcpp::wrap(simplify_polyline(x, y, group, tolerance));
+    return rcpp_result_gen;
+END_RCPP
+}
+// start_edf_import
+SEXP start_edf_import(std::string filename, int consistency, bool import_events, bool import_recordings, bool import_samples, bool import_trial_summary, LogicalVector sample_attr_flag, double memory_limit, std::string start_marker_string, std::string end_marker_string, Nullable<NumericMatrix> trial_index, Nullable<NumericMatrix> recording_blocks, Nullable<List> sample_filter);
+RcppExport SEXP _eyelinkReader_start_edf_import(SEXP filenameSEXP, SEXP consistencySEXP, SEXP import_eventsSEXP, SEXP import_recordingsSEXP, SEXP import_samplesSEXP, SEXP import_trial_summarySEXP, SEXP sample_attr_flagSEXP, SEXP memory_limitSEXP, SEXP start_marker_stringSEXP, SEXP end_marker_stringSEXP, SEXP trial_indexSEXP, SEXP recording_blocksSEXP, SEXP sample_filterSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type filename(filenameSEXP);
+    Rcpp::traits::input_parameter< int >::type consistency(consistencySEXP);
+    Rcpp::traits::input_parameter< bool >::type import_events(import_eventsSEXP);
+    Rcpp::traits::input_parameter< bool >::type import_recordings(import_recordingsSEXP);
+    Rcpp::traits::input_parameter< bool >::type import_samples(import_samplesSEXP);
+    Rcpp::traits::input_parameter< bool >::type import_trial_summary(import_trial_summarySEXP);
+    Rcpp::traits::input_parameter< LogicalVector >::type sample_attr_flag(sample_attr_flagSEXP);
+    Rcpp::traits::input_parameter< double >::type memory_limit(memory_limitSEXP);
+    Rcpp::traits::input_parameter< std::string >::type start_marker_string(start_marker_stringSEXP);
+    Rcpp::traits::input_parameter< std::string >::type end_marker_string(end_marker_stringSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericMatrix> >::type trial_index(trial_indexSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericMatrix> >::type recording_blocks(recording_blocksSEXP);
+    Rcpp::traits::input_parameter< Nullable<List> >::type sample_filter(sample_filterSEXP);
+    rcpp_result_gen = Rcpp::wrap(start_edf_import(filename, consistency, import_events, import_recordings, import_samples, import_trial_summary, sample_attr_flag, memory_limit, start_marker_string, end_marker_string, trial_index, recording_blocks, sample_filter));
+    return rcpp_result_gen;
+END_RCPP
+}
+// write_column_store
+double write_column_store(std::string filename, List tables, List objects, int chunk_rows);
+RcppExport SEXP _eyelinkReader_write_column_store(SEXP filenameSEXP, SEXP tablesSEXP, SEXP objectsSEXP, SEXP chunk_rowsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type filename(filenameSEXP);
+    Rcpp::traits::input_parameter< List >::type tables(tablesSEXP);
+    Rcpp::traits::input_parameter< List >::type objects(objectsSEXP);
+    Rcpp::traits::input_parameter< int >::type chunk_rows(chunk_rowsSEXP);
+    rcpp_result_gen = Rcpp::wrap(write_column_store(filename, tables, objects, chunk_rows));
+    return rcpp_result_gen;
+END_RCPP
+}
 
 static const R_CallMethodDef CallEntries[] = {
+    {"_eyelinkReader_accumulate_heatmap", (DL_FUNC) &_eyelinkReader_accumulate_heatmap, 6},
+    {"_eyelinkReader_bin_points", (DL_FUNC) &_eyelinkReader_bin_points, 5},
+    {"_eyelinkReader_bin_segments", (DL_FUNC) &_eyelinkReader_bin_segments, 7},
+    {"_eyelinkReader_bind_tables", (DL_FUNC) &_eyelinkReader_bind_tables, 3},
+    {"_eyelinkReader_cancel_edf_import", (DL_FUNC) &_eyelinkReader_cancel_edf_import, 1},
+    {"_eyelinkReader_collect_edf_import", (DL_FUNC) &_eyelinkReader_collect_edf_import, 1},
+    {"_eyelinkReader_compare_scanpath_pairs", (DL_FUNC) &_eyelinkReader_compare_scanpath_pairs, 10},
     {"_eyelinkReader_compiled_library_status", (DL_FUNC) &_eyelinkReader_compiled_library_status, 0},
     {"_eyelinkReader_convert_NAs", (DL_FUNC) &_eyelinkReader_convert_NAs, 1},
-    {"_eyelinkReader_read_edf_file", (DL_FUNC) &_eyelinkReader_read_edf_file, 9},
+    {"_eyelinkReader_edf_import_progress", (DL_FUNC) &_eyelinkReader_edf_import_progress, 1},
+    {"_eyelinkReader_epoch_sample_columns", (DL_FUNC) &_eyelinkReader_epoch_sample_columns, 10},
+    {"_eyelinkReader_filter_sample_columns", (DL_FUNC) &_eyelinkReader_filter_sample_columns, 8},
+    {"_eyelinkReader_gaussian_blur", (DL_FUNC) &_eyelinkReader_gaussian_blur, 2},
+    {"_eyelinkReader_map_column_file", (DL_FUNC) &_eyelinkReader_map_column_file, 4},
+    {"_eyelinkReader_match_samples_to_events", (DL_FUNC) &_eyelinkReader_match_samples_to_events, 8},
+    {"_eyelinkReader_parse_message_offsets", (DL_FUNC) &_eyelinkReader_parse_message_offsets, 2},
+    {"_eyelinkReader_parse_messages", (DL_FUNC) &_eyelinkReader_parse_messages, 2},
+    {"_eyelinkReader_parse_trial_variables", (DL_FUNC) &_eyelinkReader_parse_trial_variables, 1},
+    {"_eyelinkReader_pivot_trial_variables", (DL_FUNC) &_eyelinkReader_pivot_trial_variables, 1},
+    {"_eyelinkReader_preprocess_pupil_columns", (DL_FUNC) &_eyelinkReader_preprocess_pupil_columns, 17},
+    {"_eyelinkReader_read_column_store", (DL_FUNC) &_eyelinkReader_read_column_store, 4},
+    {"_eyelinkReader_read_edf_file", (DL_FUNC) &_eyelinkReader_read_edf_file, 14},
+    {"_eyelinkReader_read_message_index", (DL_FUNC) &_eyelinkReader_read_message_index, 2},
     {"_eyelinkReader_read_preamble_str", (DL_FUNC) &_eyelinkReader_read_preamble_str, 1},
+    {"_eyelinkReader_resolve_trial_boundaries", (DL_FUNC) &_eyelinkReader_resolve_trial_boundaries, 6},
+    {"_eyelinkReader_scan_trial_quality", (DL_FUNC) &_eyelinkReader_scan_trial_quality, 4},
+    {"_eyelinkReader_simplify_polyline", (DL_FUNC) &_eyelinkReader_simplify_polyline, 4},
+    {"_eyelinkReader_start_edf_import", (DL_FUNC) &_eyelinkReader_start_edf_import, 13},
+    {"_eyelinkReader_write_column_store", (DL_FUNC) &_eyelinkReader_write_column_store, 4},
     {NULL, NULL, 0}
 };
 
+void register_mapped_column_classes(DllInfo* dll);
 RcppExport void R_init_eyelinkReader(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    register_mapped_column_classes(dll);
 }
@@ -0,0 +1,71 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+using namespace Rcpp;
+
+//' @title Accumulates weighted points into a heatmap grid
+//' @description Adds weights of points to the bins of a fixed-resolution grid that
+//' covers the \code{bounds} rectangle. Each thread accumulates into its own grid and
+//' grids are summed at the end, so memory use depends on the grid size and the number
+//' of threads but not on the number of points. Points outside of the bounds or with missing
+//' coordinates or weights are ignored. The original \code{grid} is not modified.
+//' You don't need to call this function directly, as it is used by \code{\link{compute_heatmap}}.
+//' @param grid Numeric matrix with the current grid, rows correspond to vertical and columns to horizontal bins.
+//' @param x Numeric vector with horizontal coordinates.
+//' @param y Numeric vector with vertical coordinates.
+//' @param weight Numeric vector with weights, e.g., fixation durations.
+//' @param bounds Numeric vector with \code{left}, \code{top}, \code{right}, and \code{bottom} bounds,
+//' e.g., \code{display_coords}.
+//' @param bin_size Size of a square bin in the units of coordinates, e.g., pixels.
+//' @return Numeric matrix, \code{grid} with added weights.
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+NumericMatrix accumulate_heatmap(NumericMatrix grid, NumericVector x, NumericVector y, NumericVector weight,
+                                 NumericVector bounds, double bin_size){
+  const R_xlen_t total_points = x.size();
+  if (y.size() != total_points || weight.size() != total_points) ::Rf_error("x, y, and weight must have the same length.");
+  if (bounds.size() != 4) ::Rf_error("bounds must have four elements: left, top, right, bottom.");
+  if (!(bin_size > 0)) ::Rf_error("bin_size must be positive.");
+
+  const int rows = grid.nrow();
+  const int columns = grid.ncol();
+  const double left = bounds[0];
+  const double top = bounds[1];
+  const double width = bounds[2] - bounds[0];
+  const double height = bounds[3] - bounds[1];
+
+  // raw pointers, as R API must not be used within parallel region
+  const double* x_ptr = x.begin();
+  const double* y_ptr = y.begin();
+  const double* weight_ptr = weight.begin();
+  std::vector <double> total(grid.begin(), grid.end());
+
+  #pragma omp parallel
+  {
+    std::vector <double> local(total.size(), 0);
+
+    #pragma omp for schedule(static)
+    for(R_xlen_t iPoint = 0; iPoint < total_points; iPoint++){
+      const double dx = x_ptr[iPoint] - left;
+      const double dy = y_ptr[iPoint] - top;
+      if (std::isnan(dx) || std::isnan(dy) || std::isnan(weight_ptr[iPoint])) continue;
+      if (dx < 0 || dx > width || dy < 0 || dy > height) continue;
+
+      const int column = std::min(columns - 1, (int)(dx / bin_size));
+      const int row = std::min(rows - 1, (int)(dy / bin_size));
+
+      // column-major order, same as R matrices
+      local[(size_t)column * rows + row] += weight_ptr[iPoint];
+    }
+
+    #pragma omp critical
+    {
+      for(size_t iBin = 0; iBin < total.size(); iBin++) total[iBin] += local[iBin];
+    }
+  }
+
+  NumericMatrix accumulated(rows, columns);
+  std::copy(total.begin(), total.end(), accumulated.begin());
+  return accumulated;
+}
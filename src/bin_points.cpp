@@ -0,0 +1,76 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+using namespace Rcpp;
+
+//' @title Aggregates points on a regular 2D grid
+//' @description Points are binned on a grid with square bins that covers the
+//' \code{bounds} rectangle with \code{resolution} bins along its longer side. Points outside of
+//' the bounds or with missing coordinates are ignored. Only bins with at least one point
+//' are returned, so the size of the output depends on the grid resolution and not on the number of points.
+//' Used by \code{\link{plot.eyelinkRecording}} to plot large fixation tables.
+//' @param x Numeric vector with horizontal coordinates.
+//' @param y Numeric vector with vertical coordinates.
+//' @param value Numeric vector with values that are averaged within each bin, missing values are ignored.
+//' @param bounds Numeric vector with \code{left}, \code{top}, \code{right}, and \code{bottom} bounds,
+//' e.g., \code{display_coords}.
+//' @param resolution Number of bins along the longer side of the bounds rectangle.
+//' @return data.frame with \code{x} and \code{y} (coordinates of bin centers), \code{count} (number of points),
+//' and \code{value} (mean value, \code{NA} if no valid values) columns.
+//' @export
+//' @keywords internal
+//' @examples
+//' data(gaze)
+//' binned <- bin_points(gaze$fixations$gavx, gaze$fixations$gavy, gaze$fixations$duration,
+//'                      gaze$display_coords, 64)
+//[[Rcpp::export]]
+DataFrame bin_points(NumericVector x, NumericVector y, NumericVector value, NumericVector bounds, int resolution){
+  if (x.size() != y.size() || x.size() != value.size()) ::Rf_error("x, y, and value must have the same length.");
+  if (bounds.size() != 4) ::Rf_error("bounds must have four elements: left, top, right, bottom.");
+  if (resolution < 1) ::Rf_error("resolution must be positive.");
+
+  const double left = bounds[0];
+  const double top = bounds[1];
+  const double width = bounds[2] - bounds[0];
+  const double height = bounds[3] - bounds[1];
+  if (!(width > 0) || !(height > 0)) ::Rf_error("bounds must define a non-empty rectangle.");
+  const double bin_size = std::max(width, height) / resolution;
+  const int columns = std::max(1, (int)std::ceil(width / bin_size));
+  const int rows = std::max(1, (int)std::ceil(height / bin_size));
+
+  std::vector <double> bin_count(columns * rows, 0);
+  std::vector <double> bin_value_count(columns * rows, 0);
+  std::vector <double> bin_value_sum(columns * rows, 0);
+  for(R_xlen_t iPoint = 0; iPoint < x.size(); iPoint++){
+    if (!std::isfinite(x[iPoint]) || !std::isfinite(y[iPoint])) continue;
+    const double dx = x[iPoint] - left;
+    const double dy = y[iPoint] - top;
+    if (dx < 0 || dx > width || dy < 0 || dy > height) continue;
+
+    const int column = std::min(columns - 1, (int)(dx / bin_size));
+    const int row = std::min(rows - 1, (int)(dy / bin_size));
+    const int iBin = row * columns + column;
+    bin_count[iBin]++;
+    if (!std::isnan(value[iPoint])){
+      bin_value_count[iBin]++;
+      bin_value_sum[iBin] += value[iPoint];
+    }
+  }
+
+  std::vector <double> bin_x, bin_y, count, mean_value;
+  for(int iRow = 0; iRow < rows; iRow++){
+    for(int iColumn = 0; iColumn < columns; iColumn++){
+      const int iBin = iRow * columns + iColumn;
+      if (bin_count[iBin] == 0) continue;
+      bin_x.push_back(left + (iColumn + 0.5) * bin_size);
+      bin_y.push_back(top + (iRow + 0.5) * bin_size);
+      count.push_back(bin_count[iBin]);
+      mean_value.push_back(bin_value_count[iBin] > 0 ? bin_value_sum[iBin] / bin_value_count[iBin] : NA_REAL);
+    }
+  }
+
+  return DataFrame::create(_["x"] = bin_x,
+                           _["y"] = bin_y,
+                           _["count"] = count,
+                           _["value"] = mean_value);
+}
@@ -0,0 +1,103 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+using namespace Rcpp;
+
+// aggregated segment between two grid bins
+typedef struct BINNED_SEGMENT {
+  double count;
+  double value_count;
+  double value_sum;
+} BINNED_SEGMENT;
+
+//' @title Aggregates line segments by snapping their ends to a regular 2D grid
+//' @description Both ends of each segment are snapped to the centers of square bins of a grid that covers
+//' the \code{bounds} rectangle with \code{resolution} bins along its longer side. Segments that connect
+//' the same pair of bins are merged into one. Segments with an end outside of the bounds or with
+//' missing coordinates are ignored. Segments that start and end in the same bin are dropped.
+//' Used by \code{\link{plot.eyelinkRecording}} to plot large saccade tables.
+//' @param x Numeric vector with horizontal coordinates of segment starts.
+//' @param y Numeric vector with vertical coordinates of segment starts.
+//' @param xend Numeric vector with horizontal coordinates of segment ends.
+//' @param yend Numeric vector with vertical coordinates of segment ends.
+//' @param value Numeric vector with values that are averaged for merged segments, missing values are ignored.
+//' @param bounds Numeric vector with \code{left}, \code{top}, \code{right}, and \code{bottom} bounds,
+//' e.g., \code{display_coords}.
+//' @param resolution Number of bins along the longer side of the bounds rectangle.
+//' @return data.frame with \code{x}, \code{y}, \code{xend}, \code{yend}, \code{count} (number of merged segments),
+//' and \code{value} (mean value, \code{NA} if no valid values) columns.
+//' @export
+//' @keywords internal
+//' @examples
+//' data(gaze)
+//' binned <- bin_segments(gaze$saccades$gstx, gaze$saccades$gsty,
+//'                        gaze$saccades$genx, gaze$saccades$geny,
+//'                        gaze$saccades$sttime_rel, gaze$display_coords, 64)
+//[[Rcpp::export]]
+DataFrame bin_segments(NumericVector x, NumericVector y, NumericVector xend, NumericVector yend,
+                       NumericVector value, NumericVector bounds, int resolution){
+  const R_xlen_t total_segments = x.size();
+  if (y.size() != total_segments || xend.size() != total_segments || yend.size() != total_segments || value.size() != total_segments){
+    ::Rf_error("x, y, xend, yend, and value must have the same length.");
+  }
+  if (bounds.size() != 4) ::Rf_error("bounds must have four elements: left, top, right, bottom.");
+  if (resolution < 1) ::Rf_error("resolution must be positive.");
+
+  const double left = bounds[0];
+  const double top = bounds[1];
+  const double width = bounds[2] - bounds[0];
+  const double height = bounds[3] - bounds[1];
+  if (!(width > 0) || !(height > 0)) ::Rf_error("bounds must define a non-empty rectangle.");
+  const double bin_size = std::max(width, height) / resolution;
+  const long columns = std::max(1, (int)std::ceil(width / bin_size));
+  const long rows = std::max(1, (int)std::ceil(height / bin_size));
+
+  // segments keyed by indexes of the start and end bins, ordered for reproducible output
+  std::map <std::pair <long, long>, BINNED_SEGMENT> segments;
+  for(R_xlen_t iSegment = 0; iSegment < total_segments; iSegment++){
+    const double xs[2] = {x[iSegment], xend[iSegment]};
+    const double ys[2] = {y[iSegment], yend[iSegment]};
+    long bin[2];
+    bool is_valid = true;
+    for(int iEnd = 0; iEnd < 2 && is_valid; iEnd++){
+      const double dx = xs[iEnd] - left;
+      const double dy = ys[iEnd] - top;
+      if (!std::isfinite(dx) || !std::isfinite(dy) || dx < 0 || dx > width || dy < 0 || dy > height){
+        is_valid = false;
+        continue;
+      }
+      const long column = std::min(columns - 1, (long)(dx / bin_size));
+      const long row = std::min(rows - 1, (long)(dy / bin_size));
+      bin[iEnd] = row * columns + column;
+    }
+    if (!is_valid || bin[0] == bin[1]) continue;
+
+    BINNED_SEGMENT &segment = segments[std::make_pair(bin[0], bin[1])];
+    segment.count++;
+    if (!std::isnan(value[iSegment])){
+      segment.value_count++;
+      segment.value_sum += value[iSegment];
+    }
+  }
+
+  const R_xlen_t total_binned = segments.size();
+  NumericVector binned_x(total_binned), binned_y(total_binned), binned_xend(total_binned), binned_yend(total_binned);
+  NumericVector count(total_binned), mean_value(total_binned);
+  R_xlen_t iBinned = 0;
+  for(std::map <std::pair <long, long>, BINNED_SEGMENT>::const_iterator segment = segments.begin(); segment != segments.end(); ++segment, ++iBinned){
+    binned_x[iBinned] = left + (segment->first.first % columns + 0.5) * bin_size;
+    binned_y[iBinned] = top + (segment->first.first / columns + 0.5) * bin_size;
+    binned_xend[iBinned] = left + (segment->first.second % columns + 0.5) * bin_size;
+    binned_yend[iBinned] = top + (segment->first.second / columns + 0.5) * bin_size;
+    count[iBinned] = segment->second.count;
+    mean_value[iBinned] = segment->second.value_count > 0 ? segment->second.value_sum / segment->second.value_count : NA_REAL;
+  }
+
+  return DataFrame::create(_["x"] = binned_x,
+                           _["y"] = binned_y,
+                           _["xend"] = binned_xend,
+                           _["yend"] = binned_yend,
+                           _["count"] = count,
+                           _["value"] = mean_value);
+}
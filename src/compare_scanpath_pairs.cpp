@@ -0,0 +1,257 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+using namespace Rcpp;
+
+// a single scanpath: AOI sequence and fixations with valid coordinates
+typedef struct SCANPATH {
+  std::vector <int> aois;
+  std::vector <double> x;
+  std::vector <double> y;
+  std::vector <double> duration;
+} SCANPATH;
+
+// a block of pairs: rows [first_row, last_row) and columns [first_column, last_column) of the matrices
+typedef struct SCANPATH_TILE {
+  size_t first_row;
+  size_t last_row;
+  size_t first_column;
+  size_t last_column;
+} SCANPATH_TILE;
+
+// buffers reused for all pairs of a tile
+typedef struct SCANPATH_BUFFERS {
+  std::vector <size_t> edits;
+  std::vector <double> cost;
+  std::vector <double> differences[5];
+} SCANPATH_BUFFERS;
+
+// number of MultiMatch measures: vector, direction, length, position, duration
+const int MULTIMATCH_MEASURES = 5;
+
+//' @title Normalized Levenshtein similarity of two AOI sequences
+//' @description Edit distance via a single row of the dynamic programming table,
+//' normalized by the length of the longer sequence.
+//' @param std::vector <int> &a, first sequence
+//' @param std::vector <int> &b, second sequence
+//' @param std::vector <size_t> &edits, buffer for the row
+//' @return double, 1 - distance / max(length), 1 for two empty sequences.
+//' @keywords internal
+double levenshtein_similarity(const std::vector <int> &a, const std::vector <int> &b, std::vector <size_t> &edits){
+  const std::vector <int> &longer = a.size() >= b.size() ? a : b;
+  const std::vector <int> &shorter = a.size() >= b.size() ? b : a;
+  if (longer.empty()) return 1;
+
+  edits.resize(shorter.size() + 1);
+  for(size_t j = 0; j <= shorter.size(); j++) edits[j] = j;
+  for(size_t i = 1; i <= longer.size(); i++){
+    size_t diagonal = edits[0];
+    edits[0] = i;
+    for(size_t j = 1; j <= shorter.size(); j++){
+      const size_t above = edits[j];
+      edits[j] = std::min(std::min(above, edits[j - 1]) + 1, diagonal + (longer[i - 1] == shorter[j - 1] ? 0 : 1));
+      diagonal = above;
+    }
+  }
+  return 1.0 - (double)edits[shorter.size()] / longer.size();
+}
+
+//' @title Median of values, reorders the vector
+//' @param std::vector <double> &values
+//' @return double
+//' @keywords internal
+double median_of(std::vector <double> &values){
+  const size_t middle = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + middle, values.end());
+  if (values.size() % 2 == 1) return values[middle];
+  const double upper = values[middle];
+  return (upper + *std::max_element(values.begin(), values.begin() + middle)) / 2;
+}
+
+//' @title Simplified MultiMatch similarity of two scanpaths
+//' @description Saccade vectors of both scanpaths are aligned via the cheapest monotone path through
+//' the matrix of vector differences (dynamic programming over steps right, down, and diagonal).
+//' Medians of differences between aligned pairs are normalized and converted to similarities:
+//' vector difference (by twice the screen diagonal), direction (by pi), length (by the diagonal),
+//' position of starting fixations (by the diagonal), and duration of starting fixations (by the longer one).
+//' Scanpaths are not simplified before the alignment.
+//' @param SCANPATH &a
+//' @param SCANPATH &b
+//' @param double diagonal, diagonal of the screen
+//' @param SCANPATH_BUFFERS &buffers
+//' @param double* similarity, output for five measures, \code{NA} if a scanpath has fewer than two fixations.
+//' @keywords internal
+void multimatch_similarity(const SCANPATH &a, const SCANPATH &b, double diagonal, SCANPATH_BUFFERS &buffers, double* similarity){
+  if (a.x.size() < 2 || b.x.size() < 2){
+    for(int iMeasure = 0; iMeasure < MULTIMATCH_MEASURES; iMeasure++) similarity[iMeasure] = NA_REAL;
+    return;
+  }
+
+  // cumulative cost of the cheapest path, row-major over saccades of a (rows) and b (columns)
+  const size_t rows = a.x.size() - 1;
+  const size_t columns = b.x.size() - 1;
+  std::vector <double> &cost = buffers.cost;
+  cost.resize(rows * columns);
+  for(size_t i = 0; i < rows; i++){
+    const double ax = a.x[i + 1] - a.x[i];
+    const double ay = a.y[i + 1] - a.y[i];
+    for(size_t j = 0; j < columns; j++){
+      const double difference = std::sqrt(std::pow(ax - (b.x[j + 1] - b.x[j]), 2) + std::pow(ay - (b.y[j + 1] - b.y[j]), 2));
+      double previous = 0;
+      if (i > 0 && j > 0) previous = std::min(cost[(i - 1) * columns + j - 1], std::min(cost[(i - 1) * columns + j], cost[i * columns + j - 1]));
+      else if (i > 0) previous = cost[(i - 1) * columns + j];
+      else if (j > 0) previous = cost[j - 1];
+      cost[i * columns + j] = difference + previous;
+    }
+  }
+
+  // differences along the path, traced back from the last pair of saccades
+  for(int iMeasure = 0; iMeasure < MULTIMATCH_MEASURES; iMeasure++) buffers.differences[iMeasure].clear();
+  size_t i = rows - 1;
+  size_t j = columns - 1;
+  while (true){
+    const double ax = a.x[i + 1] - a.x[i];
+    const double ay = a.y[i + 1] - a.y[i];
+    const double bx = b.x[j + 1] - b.x[j];
+    const double by = b.y[j + 1] - b.y[j];
+    const double a_length = std::sqrt(ax * ax + ay * ay);
+    const double b_length = std::sqrt(bx * bx + by * by);
+    double angle = std::fabs(std::atan2(ay, ax) - std::atan2(by, bx));
+    if (angle > M_PI) angle = 2 * M_PI - angle;
+    const double longer_duration = std::max(a.duration[i], b.duration[j]);
+
+    buffers.differences[0].push_back(std::sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by)));
+    buffers.differences[1].push_back(angle);
+    buffers.differences[2].push_back(std::fabs(a_length - b_length));
+    buffers.differences[3].push_back(std::sqrt(std::pow(a.x[i] - b.x[j], 2) + std::pow(a.y[i] - b.y[j], 2)));
+    buffers.differences[4].push_back(longer_duration > 0 ? std::fabs(a.duration[i] - b.duration[j]) / longer_duration : 0);
+
+    if (i == 0 && j == 0) break;
+    if (i == 0) j--;
+    else if (j == 0) i--;
+    else {
+      const double diagonal_cost = cost[(i - 1) * columns + j - 1];
+      const double up_cost = cost[(i - 1) * columns + j];
+      const double left_cost = cost[i * columns + j - 1];
+      if (diagonal_cost <= up_cost && diagonal_cost <= left_cost){
+        i--;
+        j--;
+      }
+      else if (up_cost <= left_cost) i--;
+      else j--;
+    }
+  }
+
+  const double normalization[MULTIMATCH_MEASURES] = {2 * diagonal, M_PI, diagonal, diagonal, 1};
+  for(int iMeasure = 0; iMeasure < MULTIMATCH_MEASURES; iMeasure++){
+    similarity[iMeasure] = 1 - median_of(buffers.differences[iMeasure]) / normalization[iMeasure];
+  }
+}
+
+//' @title Pairwise similarity of scanpaths
+//' @description Computes symmetric similarity matrices for all pairs of scanpaths. Scanpath \code{i} consists
+//' of fixations \code{first[i]} to \code{first[i + 1] - 1} (zero-based), sorted by time.
+//' Normalized Levenshtein similarity (\code{1 - distance / length of the longer sequence}) is computed for
+//' sequences of AOI codes (fixations outside of AOIs, i.e., \code{NA}, are dropped). Simplified MultiMatch
+//' aligns saccade vectors via dynamic programming and reports vector, direction, length, position, and duration
+//' similarities, using fixations with valid coordinates only. Pairs are split into square tiles that are
+//' processed in parallel, so that scanpaths of a tile stay in cache.
+//' You don't need to call this function directly, as it is used by \code{\link{compare_scanpaths}}.
+//' @param first Integer vector with offsets of scanpaths, its length is number of scanpaths + 1.
+//' @param aoi Integer vector with AOI codes of fixations.
+//' @param x Numeric vector with horizontal position of fixations.
+//' @param y Numeric vector with vertical position of fixations.
+//' @param duration Numeric vector with duration of fixations.
+//' @param levenshtein Whether to compute Levenshtein similarity.
+//' @param multimatch Whether to compute MultiMatch similarities.
+//' @param diagonal Diagonal of the screen used to normalize MultiMatch differences.
+//' @param collapse Whether consecutive fixations within the same AOI count as a single AOI visit.
+//' @param tile Number of scanpaths along the side of a tile.
+//' @return Named list of numeric matrices: \code{levenshtein} and/or \code{vector}, \code{direction},
+//' \code{length}, \code{position}, \code{duration}.
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+List compare_scanpath_pairs(IntegerVector first, IntegerVector aoi, NumericVector x, NumericVector y, NumericVector duration,
+                            bool levenshtein, bool multimatch, double diagonal, bool collapse, int tile){
+  if (first.size() < 1 || first[0] != 0 || first[first.size() - 1] != aoi.size()) ::Rf_error("first must contain offsets of all fixations.");
+  if (x.size() != aoi.size() || y.size() != aoi.size() || duration.size() != aoi.size()) ::Rf_error("aoi, x, y, and duration must have the same length.");
+  if (multimatch && !(diagonal > 0)) ::Rf_error("diagonal must be positive.");
+  if (tile < 1) ::Rf_error("tile must be positive.");
+
+  // scanpaths
+  const size_t total_scanpaths = first.size() - 1;
+  std::vector <SCANPATH> scanpaths(total_scanpaths);
+  for(size_t iScanpath = 0; iScanpath < total_scanpaths; iScanpath++){
+    if (first[iScanpath + 1] < first[iScanpath]) ::Rf_error("first must be sorted.");
+    SCANPATH &scanpath = scanpaths[iScanpath];
+    for(int iFixation = first[iScanpath]; iFixation < first[iScanpath + 1]; iFixation++){
+      if (aoi[iFixation] != NA_INTEGER && (!collapse || scanpath.aois.empty() || scanpath.aois.back() != aoi[iFixation])){
+        scanpath.aois.push_back(aoi[iFixation]);
+      }
+      if (std::isfinite(x[iFixation]) && std::isfinite(y[iFixation])){
+        scanpath.x.push_back(x[iFixation]);
+        scanpath.y.push_back(y[iFixation]);
+        scanpath.duration.push_back(ISNAN(duration[iFixation]) ? 0 : duration[iFixation]);
+      }
+    }
+  }
+
+  // output matrices
+  const char* multimatch_names[MULTIMATCH_MEASURES] = {"vector", "direction", "length", "position", "duration"};
+  const int total_measures = (levenshtein ? 1 : 0) + (multimatch ? MULTIMATCH_MEASURES : 0);
+  std::vector <double*> levenshtein_out;
+  std::vector <double*> multimatch_out;
+  List similarity(total_measures);
+  CharacterVector measure_names(total_measures);
+  int iOut = 0;
+  if (levenshtein){
+    NumericMatrix matrix(total_scanpaths, total_scanpaths);
+    levenshtein_out.push_back(matrix.begin());
+    similarity[iOut] = matrix;
+    measure_names[iOut++] = "levenshtein";
+  }
+  if (multimatch){
+    for(int iMeasure = 0; iMeasure < MULTIMATCH_MEASURES; iMeasure++){
+      NumericMatrix matrix(total_scanpaths, total_scanpaths);
+      multimatch_out.push_back(matrix.begin());
+      similarity[iOut] = matrix;
+      measure_names[iOut++] = multimatch_names[iMeasure];
+    }
+  }
+  similarity.attr("names") = measure_names;
+
+  // tiles of the upper triangle, including the diagonal
+  std::vector <SCANPATH_TILE> tiles;
+  for(size_t first_row = 0; first_row < total_scanpaths; first_row += tile){
+    for(size_t first_column = first_row; first_column < total_scanpaths; first_column += tile){
+      SCANPATH_TILE pairs = {first_row, std::min(first_row + tile, total_scanpaths),
+                             first_column, std::min(first_column + tile, total_scanpaths)};
+      tiles.push_back(pairs);
+    }
+  }
+
+  const int total_tiles = tiles.size();
+  #pragma omp parallel for schedule(dynamic)
+  for(int iTile = 0; iTile < total_tiles; iTile++){
+    SCANPATH_BUFFERS buffers;
+    double pair_similarity[MULTIMATCH_MEASURES];
+    for(size_t iRow = tiles[iTile].first_row; iRow < tiles[iTile].last_row; iRow++){
+      for(size_t iColumn = std::max(iRow, tiles[iTile].first_column); iColumn < tiles[iTile].last_column; iColumn++){
+        const size_t upper = iRow + total_scanpaths * iColumn;
+        const size_t lower = iColumn + total_scanpaths * iRow;
+        if (levenshtein){
+          levenshtein_out[0][upper] = levenshtein_out[0][lower] = levenshtein_similarity(scanpaths[iRow].aois, scanpaths[iColumn].aois, buffers.edits);
+        }
+        if (multimatch){
+          multimatch_similarity(scanpaths[iRow], scanpaths[iColumn], diagonal, buffers, pair_similarity);
+          for(int iMeasure = 0; iMeasure < MULTIMATCH_MEASURES; iMeasure++){
+            multimatch_out[iMeasure][upper] = multimatch_out[iMeasure][lower] = pair_similarity[iMeasure];
+          }
+        }
+      }
+    }
+  }
+
+  return similarity;
+}
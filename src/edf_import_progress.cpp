@@ -0,0 +1,17 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+
+//' @title Reports progress of an import
+//' @description Can be called at any time, does not wait for the worker thread.
+//' DO NOT call this function directly. Instead, use \code{\link{import_progress}} function.
+//' @param handle external pointer created by \code{\link{start_edf_import}}
+//' @export
+//' @keywords internal
+//' @return List with status (\code{"running"}, \code{"done"}, \code{"cancelled"}, or \code{"failed"}),
+//' total number of trials (\code{NA}, while trials are being counted), number of trials done,
+//' and number of samples and bytes decoded.
+//[[Rcpp::export]]
+List edf_import_progress(SEXP handle){
+  return(List::create());
+}
@@ -0,0 +1,153 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+using namespace Rcpp;
+
+// a single epoch: rows of its trial and the anchor
+typedef struct EPOCH_TASK {
+  size_t first_row;
+  size_t rows;
+  double anchor;
+} EPOCH_TASK;
+
+// layout of the output array
+typedef struct EPOCH_ARRAY {
+  size_t epochs;
+  size_t points;
+  size_t channels;
+  bool row_major;
+
+  // column-major (epochs x points x channels) or C-contiguous row-major (same shape) index
+  size_t index(size_t iEpoch, size_t iPoint, size_t iChannel) const {
+    if (row_major) return iChannel + channels * (iPoint + points * iEpoch);
+    return iEpoch + epochs * (iPoint + points * iChannel);
+  }
+} EPOCH_ARRAY;
+
+//' @title Fills a single epoch of the output array
+//' @description Every point of the grid takes the value of the nearest sample of the trial that is
+//' no further than half of the step away from it, otherwise it is missing.
+//' @param EPOCH_TASK task
+//' @param size_t iEpoch, index of the epoch in the output array
+//' @param std::vector <const double*> &columns, pointers to sample columns
+//' @param double* time, time of samples
+//' @param double start, start of the grid relative to the anchor
+//' @param double step, step of the grid
+//' @param EPOCH_ARRAY &array, layout of the output
+//' @param T missing, value of missing points
+//' @param T* out, output array
+//' @keywords internal
+template <typename T> void fill_epoch(const EPOCH_TASK &task, size_t iEpoch, const std::vector <const double*> &columns,
+                                      const double* time, double start, double step, const EPOCH_ARRAY &array, T missing, T* out){
+  const double* trial_time = time + task.first_row;
+  for(size_t iPoint = 0; iPoint < array.points; iPoint++){
+    const double grid_time = task.anchor + start + iPoint * step;
+    long nearest = -1;
+    if (task.rows > 0 && !ISNAN(task.anchor)){
+      const size_t after = std::lower_bound(trial_time, trial_time + task.rows, grid_time) - trial_time;
+      double distance = step / 2;
+      if (after < task.rows && trial_time[after] - grid_time <= distance){
+        nearest = after;
+        distance = trial_time[after] - grid_time;
+      }
+      if (after > 0 && grid_time - trial_time[after - 1] < distance) nearest = after - 1;
+    }
+    for(size_t iChannel = 0; iChannel < array.channels; iChannel++){
+      out[array.index(iEpoch, iPoint, iChannel)] = nearest < 0 ? missing : (T)columns[iChannel][task.first_row + nearest];
+    }
+  }
+}
+
+//' @title Reshapes sample columns into a trial-aligned epoch array
+//' @description Fills a preallocated dense array epochs x time points x channels directly from sample columns,
+//' without intermediate copies. Each epoch is a trial aligned on its anchor and sampled on a fixed grid:
+//' \code{points} time points from \code{anchor + start} with \code{step}. A grid point takes the value of
+//' the nearest sample of the trial within half a step, otherwise it is \code{NA}. Epochs are filled in parallel.
+//' Samples must be sorted by time within each trial.
+//' You don't need to call this function directly, as it is used by \code{\link{epoch_samples}}.
+//' @param columns List of numeric vectors (channels).
+//' @param trial Numeric vector with trial index for every sample.
+//' @param time Numeric vector with time of every sample.
+//' @param epoch_trial Numeric vector with trial of every epoch.
+//' @param epoch_anchor Numeric vector with anchor time of every epoch.
+//' @param start Start of the grid relative to the anchor.
+//' @param step Step of the grid.
+//' @param points Number of grid points.
+//' @param single_precision Whether to return 32-bit floats (raw vector) instead of a numeric array.
+//' @param row_major Whether values are stored C-contiguous (channel changes fastest, then time, then epoch)
+//' instead of R column-major order.
+//' @return Numeric array with \code{dim} (epochs, points, channels) for column-major layout or
+//' (channels, points, epochs) for row-major layout, or a raw vector with 32-bit floats in the same order.
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+SEXP epoch_sample_columns(List columns, NumericVector trial, NumericVector time,
+                          NumericVector epoch_trial, NumericVector epoch_anchor,
+                          double start, double step, int points, bool single_precision, bool row_major){
+  const size_t rows = trial.size();
+  if ((size_t)time.size() != rows) ::Rf_error("trial and time must have the same length.");
+  if (epoch_anchor.size() != epoch_trial.size()) ::Rf_error("epoch_trial and epoch_anchor must have the same length.");
+  if (!(step > 0) || points < 1) ::Rf_error("Grid must have a positive step and at least one point.");
+  for(size_t iRow = 1; iRow < rows; iRow++){
+    if (trial[iRow] == trial[iRow - 1] && time[iRow] < time[iRow - 1]) ::Rf_error("Samples must be sorted by time within each trial.");
+  }
+
+  // columns are kept in a list, so that columns coerced to double stay protected until epochs are filled
+  List inputs(columns.size());
+  std::vector <const double*> channels;
+  for(R_xlen_t iColumn = 0; iColumn < columns.size(); iColumn++){
+    NumericVector column = columns[iColumn];
+    inputs[iColumn] = column;
+    if ((size_t)column.size() != rows) ::Rf_error("All columns must have the same length as trial.");
+    channels.push_back(column.begin());
+  }
+
+  // rows of every trial
+  std::map <double, EPOCH_TASK> trial_rows;
+  size_t first_row = 0;
+  for(size_t iRow = 1; iRow <= rows; iRow++){
+    if (iRow < rows && trial[iRow] == trial[iRow - 1]) continue;
+    if (!ISNAN(trial[first_row]) && trial_rows.count(trial[first_row]) == 0){
+      EPOCH_TASK rows_of_trial = {first_row, iRow - first_row, NA_REAL};
+      trial_rows[trial[first_row]] = rows_of_trial;
+    }
+    first_row = iRow;
+  }
+
+  std::vector <EPOCH_TASK> tasks;
+  for(R_xlen_t iEpoch = 0; iEpoch < epoch_trial.size(); iEpoch++){
+    EPOCH_TASK task = {0, 0, epoch_anchor[iEpoch]};
+    std::map <double, EPOCH_TASK>::const_iterator rows_of_trial = ISNAN(epoch_trial[iEpoch]) ? trial_rows.end() : trial_rows.find(epoch_trial[iEpoch]);
+    if (rows_of_trial != trial_rows.end()){
+      task.first_row = rows_of_trial->second.first_row;
+      task.rows = rows_of_trial->second.rows;
+    }
+    tasks.push_back(task);
+  }
+
+  // single allocation of the output
+  const EPOCH_ARRAY array = {tasks.size(), (size_t)points, channels.size(), row_major};
+  const double total_values = (double)array.epochs * array.points * array.channels;
+  SEXP out = PROTECT(single_precision ? Rf_allocVector(RAWSXP, (R_xlen_t)(total_values * sizeof(float))) : Rf_allocVector(REALSXP, (R_xlen_t)total_values));
+  float* single_out = single_precision ? (float*)RAW(out) : NULL;
+  double* double_out = single_precision ? NULL : REAL(out);
+
+  const int total_tasks = tasks.size();
+  const double* time_stamps = time.begin();
+  const double missing_double = NA_REAL;
+  const float missing_float = NAN;
+  #pragma omp parallel for schedule(dynamic)
+  for(int iTask = 0; iTask < total_tasks; iTask++){
+    if (single_precision) fill_epoch(tasks[iTask], iTask, channels, time_stamps, start, step, array, missing_float, single_out);
+    else fill_epoch(tasks[iTask], iTask, channels, time_stamps, start, step, array, missing_double, double_out);
+  }
+
+  if (!single_precision){
+    IntegerVector dims = row_major ? IntegerVector::create((int)array.channels, (int)array.points, (int)array.epochs) :
+                                     IntegerVector::create((int)array.epochs, (int)array.points, (int)array.channels);
+    Rf_setAttrib(out, R_DimSymbol, dims);
+  }
+  UNPROTECT(1);
+  return out;
+}
@@ -0,0 +1,78 @@
+#include <Rcpp.h>
+#include <eyelinkReader/signal_filters.h>
+using namespace Rcpp;
+
+// a single column of a single trial
+typedef struct FILTER_TASK {
+  const double* x;
+  double* out;
+  size_t first_row;
+  size_t rows;
+} FILTER_TASK;
+
+//' @title Filters sample columns trial by trial
+//' @description Applies Savitzky-Golay, median, or zero-phase Butterworth low-pass filter to
+//' every column within every trial (run of rows with the same \code{trial} value). Within a trial,
+//' only consecutive valid samples are filtered together: missing values and gaps in time stamps
+//' (longer than 1.5 sampling intervals) split the trial into independent segments, so that filters
+//' never bridge blinks, lost data, or trials. Trials and columns are processed in parallel.
+//' You don't need to call this function directly, as it is used by \code{\link{filter_samples}}.
+//' @param columns List of numeric vectors.
+//' @param trial Numeric vector with trial index for every sample.
+//' @param time Numeric vector with time stamps in milliseconds.
+//' @param type Filter: 0, Savitzky-Golay. 1, median. 2, Butterworth.
+//' @param window Window size in samples (Savitzky-Golay and median).
+//' @param order Polynomial order (Savitzky-Golay) or filter order (Butterworth).
+//' @param derivative Derivative order, per second (Savitzky-Golay).
+//' @param cutoff Cutoff frequency in Hz (Butterworth).
+//' @return List of filtered numeric vectors.
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+List filter_sample_columns(List columns, NumericVector trial, NumericVector time,
+                           int type, int window, int order, int derivative, double cutoff){
+  if (trial.size() != time.size()) ::Rf_error("trial and time must have the same length.");
+  const SIGNAL_FILTER filter = {type, window, order, derivative, cutoff};
+  const size_t rows = trial.size();
+
+  // trials are runs of identical trial index
+  std::vector <size_t> trial_start;
+  for(size_t iRow = 0; iRow < rows; iRow++){
+    if (iRow == 0 || !(trial[iRow] == trial[iRow - 1] || (ISNAN(trial[iRow]) && ISNAN(trial[iRow - 1])))) trial_start.push_back(iRow);
+  }
+  trial_start.push_back(rows);
+
+  // columns are kept in a list, so that columns coerced to double stay protected until the tasks are done
+  List inputs(columns.size());
+  List filtered(columns.size());
+  std::vector <FILTER_TASK> tasks;
+  for(R_xlen_t iColumn = 0; iColumn < columns.size(); iColumn++){
+    NumericVector x = columns[iColumn];
+    inputs[iColumn] = x;
+    if ((size_t)x.size() != rows) ::Rf_error("All columns must have the same length as trial.");
+    NumericVector out(rows);
+    filtered[iColumn] = out;
+    for(size_t iTrial = 0; iTrial + 1 < trial_start.size(); iTrial++){
+      FILTER_TASK task = {x.begin(), out.begin(), trial_start[iTrial], trial_start[iTrial + 1] - trial_start[iTrial]};
+      tasks.push_back(task);
+    }
+  }
+
+  const int total_tasks = tasks.size();
+  const double* time_stamps = time.begin();
+  int failed_tasks = 0;
+  #pragma omp parallel for schedule(dynamic) reduction(+:failed_tasks)
+  for(int iTask = 0; iTask < total_tasks; iTask++){
+    const FILTER_TASK &task = tasks[iTask];
+    if (!filter_trial(task.x + task.first_row, time_stamps + task.first_row, task.rows, 1, filter, task.out + task.first_row)) failed_tasks++;
+  }
+  if (failed_tasks > 0) ::Rf_error("Butterworth filter cutoff must be below the Nyquist frequency (half of the sampling rate).");
+
+  // NaN produced by filters are reported as NA
+  for(R_xlen_t iColumn = 0; iColumn < filtered.size(); iColumn++){
+    NumericVector out = filtered[iColumn];
+    for(size_t iRow = 0; iRow < rows; iRow++) if (ISNAN(out[iRow])) out[iRow] = NA_REAL;
+  }
+  filtered.attr("names") = columns.attr("names");
+  return filtered;
+}
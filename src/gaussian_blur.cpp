@@ -0,0 +1,74 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+using namespace Rcpp;
+
+//' @title Convolves a single row or column with a Gaussian kernel
+//' @description Kernel is renormalized near the edges, so that edges do not fade.
+//' @param const double* source, first element of the row or column
+//' @param double* destination, first element of the output row or column
+//' @param int length, number of elements
+//' @param size_t stride, distance between consecutive elements
+//' @param std::vector <double> kernel, one half of a symmetric kernel, including the center
+//' @keywords internal
+void gaussian_blur_line(const double* source, double* destination, int length, size_t stride, const std::vector <double> &kernel){
+  const int radius = kernel.size() - 1;
+  for(int iCenter = 0; iCenter < length; iCenter++){
+    double sum = 0;
+    double kernel_sum = 0;
+    for(int iOffset = -radius; iOffset <= radius; iOffset++){
+      const int iSource = iCenter + iOffset;
+      if (iSource < 0 || iSource >= length) continue;
+      const double k = kernel[std::abs(iOffset)];
+      sum += k * source[iSource * stride];
+      kernel_sum += k;
+    }
+    destination[iCenter * stride] = sum / kernel_sum;
+  }
+}
+
+//' @title Blurs heatmap grid with a separable Gaussian filter
+//' @description Applies a one-dimensional Gaussian kernel along the columns and then along the rows
+//' of the grid, which is equivalent to a two-dimensional Gaussian filter but costs \code{O(radius)}
+//' rather than \code{O(radius^2)} operations per bin. Rows and columns are processed in parallel.
+//' You don't need to call this function directly, as it is used by \code{\link{blur_heatmap}}.
+//' @param grid Numeric matrix with the heatmap.
+//' @param sigma Standard deviation of the Gaussian kernel in bins.
+//' @return Numeric matrix with the blurred heatmap.
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+NumericMatrix gaussian_blur(NumericMatrix grid, double sigma){
+  if (!(sigma >= 0)) ::Rf_error("sigma must be non-negative.");
+  const int rows = grid.nrow();
+  const int columns = grid.ncol();
+  NumericMatrix blurred(rows, columns);
+  if (sigma == 0 || rows == 0 || columns == 0){
+    std::copy(grid.begin(), grid.end(), blurred.begin());
+    return blurred;
+  }
+
+  // half of the kernel, truncated at three standard deviations
+  const int radius = std::max(1, (int)std::ceil(3 * sigma));
+  std::vector <double> kernel(radius + 1);
+  for(int iOffset = 0; iOffset <= radius; iOffset++) kernel[iOffset] = std::exp(-0.5 * iOffset * iOffset / (sigma * sigma));
+
+  const double* source = grid.begin();
+  double* destination = blurred.begin();
+  std::vector <double> intermediate(grid.size());
+  double* intermediate_ptr = intermediate.data();
+
+  // vertical pass: each column is contiguous in column-major order
+  #pragma omp parallel for schedule(static)
+  for(int iColumn = 0; iColumn < columns; iColumn++){
+    gaussian_blur_line(source + (size_t)iColumn * rows, intermediate_ptr + (size_t)iColumn * rows, rows, 1, kernel);
+  }
+
+  // horizontal pass: elements of a row are rows apart
+  #pragma omp parallel for schedule(static)
+  for(int iRow = 0; iRow < rows; iRow++){
+    gaussian_blur_line(intermediate_ptr + iRow, destination + iRow, columns, rows, kernel);
+  }
+
+  return blurred;
+}
@@ -0,0 +1,210 @@
+// windows.h must precede R headers to avoid clashing definitions
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <Rcpp.h>
+#include <R_ext/Altrep.h>
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+using namespace Rcpp;
+
+// Memory-mapped column files are exposed to R as ALTREP vectors: the operating system pages
+// values in and out on demand, so spilled columns do not count towards the session memory.
+// Mapping is private (copy-on-write), modifications never reach the file. The file is
+// removed once the vector is garbage collected.
+
+typedef struct MAPPED_COLUMN {
+  void* address;
+  size_t bytes;
+  R_xlen_t length;
+  std::string filename;
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+#endif
+} MAPPED_COLUMN;
+
+static R_altrep_class_t mapped_real_class;
+static R_altrep_class_t mapped_integer_class;
+
+//' @title Unmaps column file and removes it
+//' @param SEXP pointer, external pointer to MAPPED_COLUMN
+//' @keywords internal
+static void finalize_mapped_column(SEXP pointer){
+  MAPPED_COLUMN* column = (MAPPED_COLUMN*)R_ExternalPtrAddr(pointer);
+  if (column == NULL) return;
+#ifdef _WIN32
+  UnmapViewOfFile(column->address);
+  CloseHandle(column->mapping);
+  CloseHandle(column->file);
+#else
+  munmap(column->address, column->bytes);
+#endif
+  remove(column->filename.c_str());
+  delete column;
+  R_ClearExternalPtr(pointer);
+}
+
+//' @title Maps file into memory
+//' @param std::string filename
+//' @param size_t bytes, expected size of the file
+//' @return MAPPED_COLUMN*, NULL if file could not be mapped
+//' @keywords internal
+static MAPPED_COLUMN* map_file(std::string filename, size_t bytes){
+  MAPPED_COLUMN* column = new MAPPED_COLUMN;
+  column->filename = filename;
+  column->bytes = bytes;
+#ifdef _WIN32
+  column->file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  LARGE_INTEGER file_size;
+  if (column->file == INVALID_HANDLE_VALUE || !GetFileSizeEx(column->file, &file_size) || (size_t)file_size.QuadPart != bytes){
+    if (column->file != INVALID_HANDLE_VALUE) CloseHandle(column->file);
+    delete column;
+    return NULL;
+  }
+  column->mapping = CreateFileMappingA(column->file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  column->address = column->mapping == NULL ? NULL : MapViewOfFile(column->mapping, FILE_MAP_COPY, 0, 0, bytes);
+  if (column->address == NULL){
+    if (column->mapping != NULL) CloseHandle(column->mapping);
+    CloseHandle(column->file);
+    delete column;
+    return NULL;
+  }
+#else
+  const int file = open(filename.c_str(), O_RDONLY);
+  struct stat file_info;
+  if (file < 0 || fstat(file, &file_info) != 0 || (size_t)file_info.st_size != bytes){
+    if (file >= 0) close(file);
+    delete column;
+    return NULL;
+  }
+  column->address = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+  close(file);
+  if (column->address == MAP_FAILED){
+    delete column;
+    return NULL;
+  }
+#endif
+  return column;
+}
+
+static inline MAPPED_COLUMN* mapped_column(SEXP x){
+  return (MAPPED_COLUMN*)R_ExternalPtrAddr(R_altrep_data1(x));
+}
+
+// ------------------ ALTREP methods shared by both classes ------------------
+static R_xlen_t mapped_length(SEXP x){
+  return mapped_column(x)->length;
+}
+
+static Rboolean mapped_inspect(SEXP x, int pre, int deep, int pvec, void (*inspect_subtree)(SEXP, int, int, int)){
+  Rprintf("mapped column file %s\n", mapped_column(x)->filename.c_str());
+  return TRUE;
+}
+
+static void* mapped_dataptr(SEXP x, Rboolean writeable){
+  return mapped_column(x)->address;
+}
+
+static const void* mapped_dataptr_or_null(SEXP x){
+  return mapped_column(x)->address;
+}
+
+// ------------------ type-specific ALTREP methods ------------------
+static double mapped_real_elt(SEXP x, R_xlen_t i){
+  return ((const double*)mapped_column(x)->address)[i];
+}
+
+static R_xlen_t mapped_real_get_region(SEXP x, R_xlen_t start, R_xlen_t size, double* buffer){
+  const R_xlen_t count = std::min(size, mapped_column(x)->length - start);
+  std::copy((const double*)mapped_column(x)->address + start, (const double*)mapped_column(x)->address + start + count, buffer);
+  return count;
+}
+
+static int mapped_integer_elt(SEXP x, R_xlen_t i){
+  return ((const int*)mapped_column(x)->address)[i];
+}
+
+static R_xlen_t mapped_integer_get_region(SEXP x, R_xlen_t start, R_xlen_t size, int* buffer){
+  const R_xlen_t count = std::min(size, mapped_column(x)->length - start);
+  std::copy((const int*)mapped_column(x)->address + start, (const int*)mapped_column(x)->address + start + count, buffer);
+  return count;
+}
+
+//' @title Registers ALTREP classes for memory-mapped column files
+//' @param DllInfo* dll
+//' @keywords internal
+// [[Rcpp::init]]
+void register_mapped_column_classes(DllInfo* dll){
+  mapped_real_class = R_make_altreal_class("mapped_real", "eyelinkReader", dll);
+  R_set_altrep_Length_method(mapped_real_class, mapped_length);
+  R_set_altrep_Inspect_method(mapped_real_class, mapped_inspect);
+  R_set_altvec_Dataptr_method(mapped_real_class, mapped_dataptr);
+  R_set_altvec_Dataptr_or_null_method(mapped_real_class, mapped_dataptr_or_null);
+  R_set_altreal_Elt_method(mapped_real_class, mapped_real_elt);
+  R_set_altreal_Get_region_method(mapped_real_class, mapped_real_get_region);
+
+  mapped_integer_class = R_make_altinteger_class("mapped_integer", "eyelinkReader", dll);
+  R_set_altrep_Length_method(mapped_integer_class, mapped_length);
+  R_set_altrep_Inspect_method(mapped_integer_class, mapped_inspect);
+  R_set_altvec_Dataptr_method(mapped_integer_class, mapped_dataptr);
+  R_set_altvec_Dataptr_or_null_method(mapped_integer_class, mapped_dataptr_or_null);
+  R_set_altinteger_Elt_method(mapped_integer_class, mapped_integer_elt);
+  R_set_altinteger_Get_region_method(mapped_integer_class, mapped_integer_get_region);
+}
+
+//' @title Maps a column file into memory as an R vector
+//' @description Creates a vector backed by a binary file with values in the native R
+//' representation (doubles or 32-bit integers, \code{NA} encoded as in R). Values are paged
+//' in from the file on demand and the file is removed, once the vector is garbage collected.
+//' You don't need to call this function directly, as it is used by \code{\link{read_edf}}
+//' to return samples that were spilled to disk due to \code{memory_limit}.
+//' @param filename Name of the column file.
+//' @param type Either \code{"double"} or \code{"integer"}.
+//' @param length Number of values in the file.
+//' @param levels Factor levels for integer codes or \code{NULL}.
+//' @return Numeric or integer vector (factor, if \code{levels} are specified).
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+SEXP map_column_file(std::string filename, std::string type, double length, Nullable<CharacterVector> levels){
+  if (type != "double" && type != "integer") ::Rf_error("type must be either 'double' or 'integer'.");
+  const bool is_double = type == "double";
+  const size_t bytes = (size_t)length * (is_double ? sizeof(double) : sizeof(int));
+
+  SEXP column;
+  if (length == 0){
+    // empty file cannot be mapped
+    remove(filename.c_str());
+    column = PROTECT(Rf_allocVector(is_double ? REALSXP : INTSXP, 0));
+  }
+  else {
+    MAPPED_COLUMN* mapped = map_file(filename, bytes);
+    if (mapped == NULL){
+      std::stringstream error_message_stream;
+      error_message_stream << "Could not map column file '" << filename << "' into memory.";
+      ::Rf_error("%s", error_message_stream.str().c_str());
+    }
+    mapped->length = (R_xlen_t)length;
+    SEXP pointer = PROTECT(R_MakeExternalPtr(mapped, R_NilValue, R_NilValue));
+    R_RegisterCFinalizerEx(pointer, finalize_mapped_column, TRUE);
+    column = R_new_altrep(is_double ? mapped_real_class : mapped_integer_class, pointer, R_NilValue);
+    UNPROTECT(1);
+    PROTECT(column);
+  }
+
+  if (levels.isNotNull()){
+    Rf_setAttrib(column, R_LevelsSymbol, levels.get());
+    Rf_setAttrib(column, R_ClassSymbol, Rf_mkString("factor"));
+  }
+  UNPROTECT(1);
+  return column;
+}
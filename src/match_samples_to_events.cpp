@@ -0,0 +1,156 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <limits>
+#include <map>
+using namespace Rcpp;
+
+// event kinds in the order of priority: a sample within a blink and a saccade belongs to the blink
+const int EVENT_KIND_COUNT = 3;
+
+// interval of a single event
+typedef struct EVENT_INTERVAL {
+  double trial;
+  double sttime;
+  double entime;
+  int id;
+  bool operator<(const EVENT_INTERVAL &other) const {
+    if (trial != other.trial) return trial < other.trial;
+    return sttime < other.sttime;
+  }
+} EVENT_INTERVAL;
+
+//' @title Matches samples to enclosing events via a linear merge
+//' @description For each eye, samples and events of each kind are traversed in parallel,
+//' so the cost is linear in the number of samples and events. Samples must come in runs of the
+//' same trial and samples of every trial must be sorted by time, as they are in the \code{samples} table.
+//' A trial may occur in several runs, e.g., trial 0 between trials for the import by recording blocks,
+//' the merge then resumes where the previous run of that trial ended. Events are sorted
+//' by trial and onset time, if necessary. A sample belongs to an event, if it is within
+//' \code{[sttime, entime]} interval of the event in the same trial. If a sample is within events of
+//' several kinds, blinks take priority over saccades and saccades take priority over fixations.
+//' You don't need to call this function directly, as it is used by \code{\link{label_samples}}.
+//' @param sample_trial Numeric vector with trial index for each sample.
+//' @param sample_time Numeric vector with time of each sample.
+//' @param event_trial Numeric vector with trial index for each event.
+//' @param event_eye Integer vector with eye index (\code{0} for left, \code{1} for right).
+//' @param event_kind Integer vector with event kind: \code{0} for blinks, \code{1} for saccades,
+//' \code{2} for fixations.
+//' @param event_id Integer vector with event index within the table of the same kind.
+//' @param event_sttime Numeric vector with onset time of events.
+//' @param event_entime Numeric vector with offset time of events.
+//' @return data.frame with runs of consecutive samples that belong to the same event:
+//' \code{eye} (\code{0} or \code{1}), \code{event_kind}, \code{event_id}, \code{first_sample},
+//' and \code{last_sample} (one-based row indexes of samples).
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+DataFrame match_samples_to_events(NumericVector sample_trial,
+                                  NumericVector sample_time,
+                                  NumericVector event_trial,
+                                  IntegerVector event_eye,
+                                  IntegerVector event_kind,
+                                  IntegerVector event_id,
+                                  NumericVector event_sttime,
+                                  NumericVector event_entime){
+  const R_xlen_t total_samples = sample_time.size();
+  if (sample_trial.size() != total_samples) ::Rf_error("sample_trial and sample_time must have the same length.");
+  std::map <double, double> trial_last_time;
+  for(R_xlen_t iSample = 0; iSample < total_samples; iSample++){
+    if (ISNAN(sample_trial[iSample])) continue;
+    std::map <double, double>::iterator last_time = trial_last_time.find(sample_trial[iSample]);
+    if (last_time == trial_last_time.end()){
+      trial_last_time[sample_trial[iSample]] = sample_time[iSample];
+      continue;
+    }
+    if (sample_time[iSample] < last_time->second) ::Rf_error("Samples of every trial must be sorted by time.");
+    last_time->second = sample_time[iSample];
+  }
+
+  // splitting events by eye and kind
+  std::vector <EVENT_INTERVAL> intervals[2][EVENT_KIND_COUNT];
+  for(R_xlen_t iEvent = 0; iEvent < event_sttime.size(); iEvent++){
+    if (event_eye[iEvent] < 0 || event_eye[iEvent] > 1) continue;
+    if (event_kind[iEvent] < 0 || event_kind[iEvent] >= EVENT_KIND_COUNT) continue;
+    EVENT_INTERVAL interval = {event_trial[iEvent], event_sttime[iEvent], event_entime[iEvent], event_id[iEvent]};
+    intervals[event_eye[iEvent]][event_kind[iEvent]].push_back(interval);
+  }
+
+  std::vector <int> run_eye;
+  std::vector <int> run_kind;
+  std::vector <int> run_id;
+  std::vector <double> run_first;
+  std::vector <double> run_last;
+  for(int iEye = 0; iEye < 2; iEye++){
+    size_t current[EVENT_KIND_COUNT];
+    std::map <double, size_t> resume[EVENT_KIND_COUNT];
+    for(int iKind = 0; iKind < EVENT_KIND_COUNT; iKind++){
+      if (!std::is_sorted(intervals[iEye][iKind].begin(), intervals[iEye][iKind].end())){
+        std::stable_sort(intervals[iEye][iKind].begin(), intervals[iEye][iKind].end());
+      }
+      current[iKind] = 0;
+    }
+
+    for(R_xlen_t iSample = 0; iSample < total_samples; iSample++){
+      const double trial = sample_trial[iSample];
+      const double time = sample_time[iSample];
+      if (ISNAN(trial)) continue;
+
+      // new run of a trial: the merge starts at the first event of the trial or where it stopped for it before
+      if (iSample == 0 || trial != sample_trial[iSample - 1]){
+        for(int iKind = 0; iKind < EVENT_KIND_COUNT; iKind++){
+          const std::vector <EVENT_INTERVAL> &kind_intervals = intervals[iEye][iKind];
+          if (iSample > 0 && !ISNAN(sample_trial[iSample - 1])) resume[iKind][sample_trial[iSample - 1]] = current[iKind];
+          std::map <double, size_t>::const_iterator resumed = resume[iKind].find(trial);
+          if (resumed != resume[iKind].end()) current[iKind] = resumed->second;
+          else {
+            const EVENT_INTERVAL trial_start = {trial, -std::numeric_limits<double>::infinity(), 0, 0};
+            current[iKind] = std::lower_bound(kind_intervals.begin(), kind_intervals.end(), trial_start) - kind_intervals.begin();
+          }
+        }
+      }
+
+      // finding an event with the highest priority that encloses the sample
+      int matched_kind = -1;
+      int matched_id = NA_INTEGER;
+      for(int iKind = 0; iKind < EVENT_KIND_COUNT; iKind++){
+        const std::vector <EVENT_INTERVAL> &kind_intervals = intervals[iEye][iKind];
+        size_t &iInterval = current[iKind];
+        while (iInterval < kind_intervals.size() &&
+               (kind_intervals[iInterval].trial < trial ||
+               (kind_intervals[iInterval].trial == trial && kind_intervals[iInterval].entime < time))){
+          iInterval++;
+        }
+        if (matched_kind < 0 &&
+            iInterval < kind_intervals.size() &&
+            kind_intervals[iInterval].trial == trial &&
+            kind_intervals[iInterval].sttime <= time){
+          matched_kind = iKind;
+          matched_id = kind_intervals[iInterval].id;
+        }
+      }
+      if (matched_kind < 0) continue;
+
+      // extending the current run or starting a new one
+      if (!run_eye.empty() &&
+          run_eye.back() == iEye &&
+          run_kind.back() == matched_kind &&
+          run_id.back() == matched_id &&
+          run_last.back() == iSample){
+        run_last.back() = iSample + 1;
+      }
+      else {
+        run_eye.push_back(iEye);
+        run_kind.push_back(matched_kind);
+        run_id.push_back(matched_id);
+        run_first.push_back(iSample + 1);
+        run_last.push_back(iSample + 1);
+      }
+    }
+  }
+
+  return DataFrame::create(_["eye"] = run_eye,
+                           _["event_kind"] = run_kind,
+                           _["event_id"] = run_id,
+                           _["first_sample"] = run_first,
+                           _["last_sample"] = run_last);
+}
@@ -0,0 +1,129 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+using namespace Rcpp;
+
+// true for characters matched by [:space:]
+inline bool is_offset_space(char c){
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') || (c == '\f') || (c == '\v');
+}
+
+// event row with its (adjusted) time, ordered by time and then by original position
+typedef struct TIMED_ROW {
+  double time;
+  R_xlen_t row;
+  bool operator<(const TIMED_ROW &other) const {
+    if (time != other.time) return time < other.time;
+    return row < other.row;
+  }
+} TIMED_ROW;
+
+//' @title Parses a leading signed integer offset
+//' @description Matches the same messages as \code{"^[-+]?[:digit:]+[:space:]+"} regular expression,
+//' i.e., an optional sign, at least one digit, and at least one white space.
+//' @param const char* text, message
+//' @param double offset, parsed offset
+//' @param const char* rest, the rest of the message after the offset and white spaces
+//' @return bool, whether the message starts with an offset
+//' @keywords internal
+bool parse_leading_offset(const char* text, double &offset, const char* &rest){
+  const char* current = text;
+  bool negative = false;
+  if (*current == '-' || *current == '+'){
+    negative = (*current == '-');
+    current++;
+  }
+  const char* digits_start = current;
+  double value = 0;
+  while (*current >= '0' && *current <= '9'){
+    value = value * 10 + (*current - '0');
+    current++;
+  }
+  if (current == digits_start || !is_offset_space(*current)) return false;
+  while (is_offset_space(*current)) current++;
+
+  offset = negative ? -value : value;
+  rest = current;
+  return true;
+}
+
+//' @title Parses time offsets embedded in messages
+//' @description Finds messages that start with an integer offset followed by a white space,
+//' e.g. \code{"-50 TARGET_ONSET"}, without using regular expressions. Computes the order of
+//' events after the adjustment: only the adjusted events move, the rest keep their order.
+//' Adjusted events are sorted and merged with the rest using the running maximum of their
+//' time, so that events that are not sorted by \code{sttime} (e.g., \code{END*} events that
+//' carry the start time of their event) do not require a full sort. For events sorted by
+//' time this is identical to a stable sort.
+//' You don't need to call this function directly, as it is used by \code{\link{adjust_message_time}}.
+//' @param message Character vector with messages.
+//' @param sttime Numeric vector with event times.
+//' @return List with \code{offset} (numeric, \code{NA} for messages without an offset),
+//' \code{message} (messages without offsets), and \code{order} (one-based row order after
+//' the adjustment or \code{NULL}, if order is unchanged).
+//' @export
+//' @keywords internal
+//' @examples
+//' parse_message_offsets(c("-50 TARGET_ONSET", "TRIGGER"), c(100, 120))
+//[[Rcpp::export]]
+List parse_message_offsets(CharacterVector message, NumericVector sttime){
+  if (message.size() != sttime.size()) ::Rf_error("message and sttime must have the same length.");
+  const R_xlen_t total_rows = message.size();
+
+  NumericVector offset(total_rows, NA_REAL);
+  CharacterVector adjusted_message(total_rows);
+  std::vector <TIMED_ROW> unchanged_rows;
+  std::vector <TIMED_ROW> adjusted_rows;
+  unchanged_rows.reserve(total_rows);
+  double latest_time = -std::numeric_limits<double>::infinity();
+  for(R_xlen_t iRow = 0; iRow < total_rows; iRow++){
+    adjusted_message[iRow] = message[iRow];
+
+    double row_offset;
+    const char* rest;
+    if (message[iRow] != NA_STRING && parse_leading_offset(CHAR(message[iRow]), row_offset, rest)){
+      SEXP message_char = message[iRow];
+      offset[iRow] = row_offset;
+      adjusted_message[iRow] = Rf_mkCharCE(rest, Rf_getCharCE(message_char));
+
+      // events without valid time stay in place
+      if (!ISNAN(sttime[iRow])){
+        TIMED_ROW timed_row = {sttime[iRow] + row_offset, iRow};
+        adjusted_rows.push_back(timed_row);
+        continue;
+      }
+    }
+
+    // unchanged rows are keyed by the running maximum of time, which is sorted by construction
+    if (!ISNAN(sttime[iRow]) && sttime[iRow] > latest_time) latest_time = sttime[iRow];
+    TIMED_ROW timed_row = {latest_time, iRow};
+    unchanged_rows.push_back(timed_row);
+  }
+
+  // no adjustments, nothing to re-order
+  if (adjusted_rows.empty()){
+    return List::create(_["offset"] = offset,
+                        _["message"] = adjusted_message,
+                        _["order"] = R_NilValue);
+  }
+
+  // sorting adjusted rows and merging them with unchanged rows that keep their order
+  std::vector <TIMED_ROW> all_rows(total_rows);
+  std::sort(adjusted_rows.begin(), adjusted_rows.end());
+  std::merge(unchanged_rows.begin(), unchanged_rows.end(),
+             adjusted_rows.begin(), adjusted_rows.end(),
+             all_rows.begin());
+
+  // checking whether the order has changed at all
+  IntegerVector order(total_rows);
+  bool is_identity = true;
+  for(R_xlen_t iRow = 0; iRow < total_rows; iRow++){
+    order[iRow] = all_rows[iRow].row + 1;
+    if (all_rows[iRow].row != iRow) is_identity = false;
+  }
+
+  return List::create(_["offset"] = offset,
+                      _["message"] = adjusted_message,
+                      _["order"] = is_identity ? R_NilValue : (SEXP)order);
+}
@@ -0,0 +1,281 @@
+#include <Rcpp.h>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <sstream>
+using namespace Rcpp;
+
+// types of message fields
+enum FIELD_TYPE {FIELD_INTEGER, FIELD_DOUBLE, FIELD_STRING, FIELD_REST};
+
+// compiled message specification
+typedef struct MESSAGE_SPEC {
+  std::string prefix;
+  std::vector <std::string> field_name;
+  std::vector <FIELD_TYPE> field_type;
+
+  // matched rows, their encoding, and raw field tokens
+  std::vector <R_xlen_t> row;
+  std::vector <cetype_t> encoding;
+  std::vector < std::vector <std::string> > tokens;
+  std::vector < std::vector <bool> > missing;
+} MESSAGE_SPEC;
+
+// node of a prefix trie, specs lists all specs whose prefix ends at this node
+typedef struct PREFIX_NODE {
+  std::map <unsigned char, size_t> children;
+  std::vector <size_t> specs;
+} PREFIX_NODE;
+
+// true for characters that separate fields
+inline bool is_field_separator(char c){
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+//' @title Converts field type label into FIELD_TYPE
+//' @param std::string type_label, one of "integer", "double", "string", or "rest".
+//' @return FIELD_TYPE
+//' @keywords internal
+FIELD_TYPE field_type_from_label(const std::string &type_label){
+  if (type_label == "integer") return FIELD_INTEGER;
+  if (type_label == "double") return FIELD_DOUBLE;
+  if (type_label == "string") return FIELD_STRING;
+  if (type_label == "rest") return FIELD_REST;
+
+  std::stringstream error_message;
+  error_message << "Unknown field type '" << type_label << "', must be 'integer', 'double', 'string', or 'rest'.";
+  ::Rf_error("%s", error_message.str().c_str());
+  return FIELD_STRING;
+}
+
+//' @title Compiles a list of message specifications
+//' @param List specs, list of specifications with \code{prefix} and \code{fields}.
+//' @return std::vector <MESSAGE_SPEC>
+//' @keywords internal
+std::vector <MESSAGE_SPEC> compile_message_specs(List specs){
+  std::vector <MESSAGE_SPEC> compiled(specs.size());
+  for(R_xlen_t iSpec = 0; iSpec < specs.size(); iSpec++){
+    List spec = specs[iSpec];
+    if (!spec.containsElementNamed("prefix") || !spec.containsElementNamed("fields")){
+      std::stringstream error_message;
+      error_message << "Message specification #" << iSpec + 1 << " must have 'prefix' and 'fields' elements.";
+      ::Rf_error("%s", error_message.str().c_str());
+    }
+    compiled[iSpec].prefix = as<std::string>(spec["prefix"]);
+    if (compiled[iSpec].prefix.empty()){
+      std::stringstream error_message;
+      error_message << "Message specification #" << iSpec + 1 << " has an empty prefix.";
+      ::Rf_error("%s", error_message.str().c_str());
+    }
+
+    CharacterVector fields = spec["fields"];
+    if (fields.size() > 0 && Rf_isNull(fields.names())){
+      std::stringstream error_message;
+      error_message << "Message specification #" << iSpec + 1 << ": fields must be a named character vector.";
+      ::Rf_error("%s", error_message.str().c_str());
+    }
+    std::vector <std::string> field_types = as< std::vector <std::string> >(fields);
+    compiled[iSpec].field_name = as< std::vector <std::string> >(fields.names());
+    for(size_t iField = 0; iField < field_types.size(); iField++){
+      compiled[iSpec].field_type.push_back(field_type_from_label(field_types[iField]));
+      if (compiled[iSpec].field_type.back() == FIELD_REST && iField != field_types.size() - 1){
+        std::stringstream error_message;
+        error_message << "Message specification #" << iSpec + 1 << ": only the last field can be of type 'rest'.";
+        ::Rf_error("%s", error_message.str().c_str());
+      }
+    }
+    compiled[iSpec].tokens.resize(fields.size());
+    compiled[iSpec].missing.resize(fields.size());
+  }
+  return compiled;
+}
+
+//' @title Builds a prefix trie for all specs
+//' @param std::vector <MESSAGE_SPEC> specs
+//' @return std::vector <PREFIX_NODE>, with root at index 0.
+//' @keywords internal
+std::vector <PREFIX_NODE> build_prefix_trie(const std::vector <MESSAGE_SPEC> &specs){
+  std::vector <PREFIX_NODE> trie(1);
+  for(size_t iSpec = 0; iSpec < specs.size(); iSpec++){
+    size_t node = 0;
+    for(size_t iChar = 0; iChar < specs[iSpec].prefix.size(); iChar++){
+      unsigned char c = specs[iSpec].prefix[iChar];
+      std::map <unsigned char, size_t>::iterator child = trie[node].children.find(c);
+      if (child == trie[node].children.end()){
+        trie.push_back(PREFIX_NODE());
+        trie[node].children[c] = trie.size() - 1;
+        node = trie.size() - 1;
+      }
+      else {
+        node = child->second;
+      }
+    }
+    trie[node].specs.push_back(iSpec);
+  }
+  return trie;
+}
+
+//' @title Splits the remainder of the message into fields
+//' @description Fields are separated by white spaces. A field of type \code{rest}
+//' consumes the (trimmed) remainder of the message. Missing fields are \code{NA}.
+//' @param MESSAGE_SPEC spec, specification with matched rows
+//' @param const char* text, message text after the prefix
+//' @keywords internal
+void tokenize_message(MESSAGE_SPEC &spec, const char* text){
+  const char* end = text + strlen(text);
+  for(size_t iField = 0; iField < spec.field_type.size(); iField++){
+    while (text < end && is_field_separator(*text)) text++;
+    if (spec.field_type[iField] == FIELD_REST){
+      const char* rest_end = end;
+      while (rest_end > text && is_field_separator(*(rest_end - 1))) rest_end--;
+      spec.tokens[iField].push_back(std::string(text, rest_end));
+      spec.missing[iField].push_back(false);
+      continue;
+    }
+
+    const char* token_end = text;
+    while (token_end < end && !is_field_separator(*token_end)) token_end++;
+    spec.tokens[iField].push_back(std::string(text, token_end));
+    spec.missing[iField].push_back(token_end == text);
+    text = token_end;
+  }
+}
+
+//' @title Converts a token into a double, NA if not a number
+//' @param std::string token
+//' @return double
+//' @keywords internal
+double token_to_double(const std::string &token){
+  const char* text = token.c_str();
+  char* end;
+  double value = strtod(text, &end);
+  if (end == text || *end != '\0') return NA_REAL;
+  return value;
+}
+
+//' @title Converts a token into an integer, NA if not a number
+//' @description Fractional part is truncated, same as in \code{as.integer()}.
+//' @param std::string token
+//' @return int
+//' @keywords internal
+int token_to_integer(const std::string &token){
+  double value = token_to_double(token);
+  if (std::isnan(value) || value <= INT_MIN || value >= (double)INT_MAX + 1.0) return NA_INTEGER;
+  return (int)value;
+}
+
+//' @title Extracts message fields for several message types in a single pass
+//' @description Finds all messages that start with one of the prefixes
+//' in a single scan of the \code{message} column, using a prefix trie that matches all
+//' specifications at once. Text following the prefix is split into white space separated
+//' fields that are converted to the requested type. Messages that match several
+//' prefixes are included in every matching table.
+//' You don't need to call this function directly, as it is used by \code{\link{extract_messages}}.
+//' @param events data.frame with \code{trial}, \code{sttime}, \code{sttime_rel}, and \code{message} columns,
+//' i.e., \code{events} slot of the \code{\link{eyelinkRecording}} object.
+//' @param specs List of message specifications, each is a list with a \code{prefix} string and
+//' \code{fields}, a named character vector with field types: \code{"integer"}, \code{"double"},
+//' \code{"string"} (single word), or \code{"rest"} (the rest of the message, can contain white spaces,
+//' allowed only as the last field).
+//' @return List of data.frames, one per specification, with \code{trial}, \code{sttime}, \code{sttime_rel}
+//' columns followed by fields. Fields that are missing or cannot be converted are \code{NA}.
+//' @export
+//' @keywords internal
+//' @examples
+//' data(gaze)
+//' messages <- parse_messages(gaze$events,
+//'                            list(triggers = list(prefix = "TRIGGER", fields = c(label = "rest"))))
+//[[Rcpp::export]]
+List parse_messages(DataFrame events, List specs){
+  std::vector <MESSAGE_SPEC> compiled = compile_message_specs(specs);
+  std::vector <PREFIX_NODE> trie = build_prefix_trie(compiled);
+
+  CharacterVector message = events["message"];
+  NumericVector trial = events["trial"];
+  NumericVector sttime = events["sttime"];
+  NumericVector sttime_rel = events["sttime_rel"];
+
+  // single pass over all messages
+  for(R_xlen_t iRow = 0; iRow < message.size(); iRow++){
+    if (message[iRow] == NA_STRING) continue;
+    SEXP message_char = message[iRow];
+    const unsigned char* text = (const unsigned char*)CHAR(message_char);
+
+    size_t node = 0;
+    for(size_t iChar = 0; ; iChar++){
+      for(size_t iSpec = 0; iSpec < trie[node].specs.size(); iSpec++){
+        MESSAGE_SPEC &spec = compiled[trie[node].specs[iSpec]];
+        spec.row.push_back(iRow);
+        spec.encoding.push_back(Rf_getCharCE(message_char));
+        tokenize_message(spec, (const char*)text + iChar);
+      }
+      if (text[iChar] == '\0') break;
+      std::map <unsigned char, size_t>::iterator child = trie[node].children.find(text[iChar]);
+      if (child == trie[node].children.end()) break;
+      node = child->second;
+    }
+  }
+
+  // converting tokens into typed tables
+  List tables(compiled.size());
+  for(size_t iSpec = 0; iSpec < compiled.size(); iSpec++){
+    const MESSAGE_SPEC &spec = compiled[iSpec];
+    const R_xlen_t total_rows = spec.row.size();
+    List table(spec.field_type.size() + 3);
+    CharacterVector table_names(spec.field_type.size() + 3);
+
+    NumericVector table_trial(total_rows);
+    NumericVector table_sttime(total_rows);
+    NumericVector table_sttime_rel(total_rows);
+    for(R_xlen_t iRow = 0; iRow < total_rows; iRow++){
+      table_trial[iRow] = trial[spec.row[iRow]];
+      table_sttime[iRow] = sttime[spec.row[iRow]];
+      table_sttime_rel[iRow] = sttime_rel[spec.row[iRow]];
+    }
+    table[0] = table_trial;
+    table[1] = table_sttime;
+    table[2] = table_sttime_rel;
+    table_names[0] = "trial";
+    table_names[1] = "sttime";
+    table_names[2] = "sttime_rel";
+
+    for(size_t iField = 0; iField < spec.field_type.size(); iField++){
+      const std::vector <std::string> &tokens = spec.tokens[iField];
+      const std::vector <bool> &missing = spec.missing[iField];
+      switch(spec.field_type[iField]){
+      case FIELD_INTEGER: {
+        IntegerVector typed(total_rows);
+        for(R_xlen_t iRow = 0; iRow < total_rows; iRow++) typed[iRow] = missing[iRow] ? NA_INTEGER : token_to_integer(tokens[iRow]);
+        table[iField + 3] = typed;
+        break;
+      }
+      case FIELD_DOUBLE: {
+        NumericVector typed(total_rows);
+        for(R_xlen_t iRow = 0; iRow < total_rows; iRow++) typed[iRow] = missing[iRow] ? NA_REAL : token_to_double(tokens[iRow]);
+        table[iField + 3] = typed;
+        break;
+      }
+      case FIELD_STRING:
+      case FIELD_REST: {
+        CharacterVector typed(total_rows);
+        for(R_xlen_t iRow = 0; iRow < total_rows; iRow++){
+          if (missing[iRow]) typed[iRow] = NA_STRING;
+          else typed[iRow] = Rf_mkCharLenCE(tokens[iRow].c_str(), tokens[iRow].size(), spec.encoding[iRow]);
+        }
+        table[iField + 3] = typed;
+        break;
+      }
+      }
+      table_names[iField + 3] = spec.field_name[iField];
+    }
+    table.attr("names") = table_names;
+    table.attr("row.names") = IntegerVector::create(NA_INTEGER, -total_rows);
+    table.attr("class") = "data.frame";
+    tables[iSpec] = DataFrame(table);
+  }
+  tables.attr("names") = specs.attr("names");
+  return tables;
+}
@@ -0,0 +1,101 @@
+#include <Rcpp.h>
+#include <cstring>
+using namespace Rcpp;
+
+// true for characters removed by trimws()
+inline bool is_white_space(char c){
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+// trims white space at both ends of [start, end)
+inline void trim_range(const char* &start, const char* &end){
+  while (start < end && is_white_space(*start)) start++;
+  while (end > start && is_white_space(*(end - 1))) end--;
+}
+
+//' @title Parses TRIAL_VAR messages into a table of variables
+//' @description Parses messages in \code{'TRIAL_VAR <name> <value>'} or \code{'TRIAL_VAR <name>=<value>'}
+//' format in a single pass over the \code{message} column. Text preceding \code{'TRIAL_VAR'}
+//' is ignored, \code{'='} signs are treated as white spaces, and both name and value are trimmed.
+//' Values are returned as strings, see \code{\link{pivot_trial_variables}} for typed values.
+//' You don't need to call this function directly, as it is used by \code{\link{extract_variables}}.
+//' @param events data.frame with \code{trial}, \code{sttime}, \code{sttime_rel}, and \code{message} columns,
+//' i.e., \code{events} slot of the \code{\link{eyelinkRecording}} object.
+//' @return data.frame with \code{trial}, \code{sttime}, \code{sttime_rel}, \code{variable}, and \code{value} columns.
+//' @export
+//' @keywords internal
+//' @examples
+//' data(gaze)
+//' variables <- parse_trial_variables(gaze$events)
+//[[Rcpp::export]]
+DataFrame parse_trial_variables(DataFrame events){
+  const char marker[] = "TRIAL_VAR";
+  const size_t marker_length = strlen(marker);
+
+  CharacterVector message = events["message"];
+  NumericVector trial = events["trial"];
+  NumericVector sttime = events["sttime"];
+  NumericVector sttime_rel = events["sttime_rel"];
+
+  // first pass: indexes of messages with variables
+  std::vector <R_xlen_t> variable_row;
+  for(R_xlen_t iRow = 0; iRow < message.size(); iRow++){
+    if (message[iRow] == NA_STRING) continue;
+    if (strstr(CHAR(message[iRow]), marker) != NULL) variable_row.push_back(iRow);
+  }
+
+  // second pass: tokenizing only the relevant messages
+  const R_xlen_t total_variables = variable_row.size();
+  NumericVector variable_trial(total_variables);
+  NumericVector variable_sttime(total_variables);
+  NumericVector variable_sttime_rel(total_variables);
+  CharacterVector variable_name(total_variables);
+  CharacterVector variable_value(total_variables);
+  std::string assignment;
+  for(R_xlen_t iVariable = 0; iVariable < total_variables; iVariable++){
+    R_xlen_t iRow = variable_row[iVariable];
+    variable_trial[iVariable] = trial[iRow];
+    variable_sttime[iVariable] = sttime[iRow];
+    variable_sttime_rel[iVariable] = sttime_rel[iRow];
+
+    // assignment runs till the end of the message or the next marker
+    SEXP message_char = message[iRow];
+    cetype_t encoding = Rf_getCharCE(message_char);
+    const char* start = strstr(CHAR(message_char), marker) + marker_length;
+    const char* end = strstr(start, marker);
+    if (end == NULL) end = start + strlen(start);
+
+    // equal sign is just another separator
+    assignment.assign(start, end);
+    for(size_t iChar = 0; iChar < assignment.size(); iChar++){
+      if (assignment[iChar] == '=') assignment[iChar] = ' ';
+    }
+
+    // name is everything up to the first space, value is the trimmed rest
+    const char* name_start = assignment.c_str();
+    const char* name_end = name_start + assignment.size();
+    trim_range(name_start, name_end);
+    const char* value_start = name_start;
+    while (value_start < name_end && *value_start != ' ') value_start++;
+    const char* value_end = name_end;
+    name_end = value_start;
+    trim_range(name_start, name_end);
+    trim_range(value_start, value_end);
+
+    variable_name[iVariable] = Rf_mkCharLenCE(name_start, name_end - name_start, encoding);
+    if (value_start == value_end){
+      // no value at all
+      variable_value[iVariable] = NA_STRING;
+    }
+    else {
+      variable_value[iVariable] = Rf_mkCharLenCE(value_start, value_end - value_start, encoding);
+    }
+  }
+
+  return DataFrame::create(_["trial"] = variable_trial,
+                           _["sttime"] = variable_sttime,
+                           _["sttime_rel"] = variable_sttime_rel,
+                           _["variable"] = variable_name,
+                           _["value"] = variable_value,
+                           _["stringsAsFactors"] = false);
+}
@@ -0,0 +1,173 @@
+#include <Rcpp.h>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <map>
+using namespace Rcpp;
+
+// column types in the order of preference
+enum VARIABLE_TYPE {VARIABLE_INTEGER, VARIABLE_DOUBLE, VARIABLE_LOGICAL, VARIABLE_STRING};
+
+// parses the entire string as an integer that fits into R integer
+inline bool parse_integer(const char* text, int &value){
+  char* end;
+  errno = 0;
+  long parsed = strtol(text, &end, 10);
+  if (end == text || *end != '\0' || errno != 0) return false;
+  if (parsed <= INT_MIN || parsed > INT_MAX) return false;
+  value = (int)parsed;
+  return true;
+}
+
+// parses the entire string as a double
+inline bool parse_double(const char* text, double &value){
+  char* end;
+  value = strtod(text, &end);
+  return (end != text) && (*end == '\0');
+}
+
+// parses TRUE/FALSE in the same forms as as.logical()
+inline bool parse_logical(const char* text, int &value){
+  if (!strcmp(text, "TRUE") || !strcmp(text, "true") || !strcmp(text, "True") || !strcmp(text, "T")){
+    value = TRUE;
+    return true;
+  }
+  if (!strcmp(text, "FALSE") || !strcmp(text, "false") || !strcmp(text, "False") || !strcmp(text, "F")){
+    value = FALSE;
+    return true;
+  }
+  return false;
+}
+
+//' @title Infers the narrowest type that fits all values
+//' @description Missing and empty values are ignored. Integer is preferred over double,
+//' double over logical, and logical over character.
+//' @param values CHARSXP values of a single column
+//' @return type of the column, see \code{VARIABLE_TYPE}
+//' @keywords internal
+VARIABLE_TYPE infer_variable_type(const std::vector <SEXP> &values){
+  bool can_be_integer = true;
+  bool can_be_double = true;
+  bool can_be_logical = true;
+  int integer_value;
+  double double_value;
+  for(size_t iValue = 0; iValue < values.size(); iValue++){
+    if (values[iValue] == NA_STRING || values[iValue] == R_NilValue) continue;
+    const char* text = CHAR(values[iValue]);
+    if (*text == '\0') continue;
+
+    if (can_be_integer) can_be_integer = parse_integer(text, integer_value);
+    if (can_be_double) can_be_double = parse_double(text, double_value);
+    if (can_be_logical) can_be_logical = parse_logical(text, integer_value);
+    if (!(can_be_integer || can_be_double || can_be_logical)) return VARIABLE_STRING;
+  }
+  if (can_be_integer) return VARIABLE_INTEGER;
+  if (can_be_double) return VARIABLE_DOUBLE;
+  if (can_be_logical) return VARIABLE_LOGICAL;
+  return VARIABLE_STRING;
+}
+
+//' @title Converts a long table of variables into a wide trial x variable table
+//' @description Converts a long table, as returned by \code{\link{parse_trial_variables}},
+//' into a wide table with one row per trial and one column per variable.
+//' Columns follow the order of the first occurrence of each variable.
+//' Type of each column is inferred from all its values: integer, double, logical, or character.
+//' If a variable was recorded more than once within a trial, the last value is used.
+//' You don't need to call this function directly, as it is used by \code{\link{extract_variables}}.
+//' @param variables data.frame with \code{trial}, \code{variable}, and \code{value} columns.
+//' @return data.frame with \code{trial} column followed by a column for each variable.
+//' @export
+//' @keywords internal
+//' @examples
+//' data(gaze)
+//' variables <- pivot_trial_variables(parse_trial_variables(gaze$events))
+//[[Rcpp::export]]
+DataFrame pivot_trial_variables(DataFrame variables){
+  NumericVector trial = variables["trial"];
+  CharacterVector variable = variables["variable"];
+  CharacterVector value = variables["value"];
+
+  // rows and columns in the order of appearance
+  std::map <double, R_xlen_t> row_index;
+  std::vector <double> row_trial;
+  std::map <std::string, R_xlen_t> column_index;
+  std::vector <SEXP> column_name;
+  std::vector <R_xlen_t> cell_row(trial.size());
+  std::vector <R_xlen_t> cell_column(trial.size());
+  for(R_xlen_t iValue = 0; iValue < trial.size(); iValue++){
+    std::map <double, R_xlen_t>::iterator row = row_index.find(trial[iValue]);
+    if (row == row_index.end()){
+      row = row_index.insert(std::make_pair(trial[iValue], (R_xlen_t)row_trial.size())).first;
+      row_trial.push_back(trial[iValue]);
+    }
+    cell_row[iValue] = row->second;
+
+    SEXP name = variable[iValue];
+    std::string key = (name == NA_STRING) ? "NA" : CHAR(name);
+    std::map <std::string, R_xlen_t>::iterator column = column_index.find(key);
+    if (column == column_index.end()){
+      column = column_index.insert(std::make_pair(key, (R_xlen_t)column_name.size())).first;
+      column_name.push_back(name);
+    }
+    cell_column[iValue] = column->second;
+  }
+
+  // filling a dense row x column grid of strings, later values overwrite earlier ones
+  const R_xlen_t total_rows = row_trial.size();
+  const R_xlen_t total_columns = column_name.size();
+  std::vector < std::vector <SEXP> > cells(total_columns, std::vector <SEXP>(total_rows, NA_STRING));
+  for(R_xlen_t iValue = 0; iValue < trial.size(); iValue++){
+    cells[cell_column[iValue]][cell_row[iValue]] = value[iValue];
+  }
+
+  // converting each column to its inferred type
+  List wide(total_columns + 1);
+  CharacterVector wide_names(total_columns + 1);
+  wide[0] = NumericVector(row_trial.begin(), row_trial.end());
+  wide_names[0] = "trial";
+  for(R_xlen_t iColumn = 0; iColumn < total_columns; iColumn++){
+    const std::vector <SEXP> &column_values = cells[iColumn];
+    int integer_value;
+    double double_value;
+    switch(infer_variable_type(column_values)){
+    case VARIABLE_INTEGER: {
+      IntegerVector typed(total_rows, NA_INTEGER);
+      for(R_xlen_t iRow = 0; iRow < total_rows; iRow++){
+        if (column_values[iRow] != NA_STRING && parse_integer(CHAR(column_values[iRow]), integer_value)) typed[iRow] = integer_value;
+      }
+      wide[iColumn + 1] = typed;
+      break;
+    }
+    case VARIABLE_DOUBLE: {
+      NumericVector typed(total_rows, NA_REAL);
+      for(R_xlen_t iRow = 0; iRow < total_rows; iRow++){
+        if (column_values[iRow] != NA_STRING && parse_double(CHAR(column_values[iRow]), double_value)) typed[iRow] = double_value;
+      }
+      wide[iColumn + 1] = typed;
+      break;
+    }
+    case VARIABLE_LOGICAL: {
+      LogicalVector typed(total_rows, NA_LOGICAL);
+      for(R_xlen_t iRow = 0; iRow < total_rows; iRow++){
+        if (column_values[iRow] != NA_STRING && parse_logical(CHAR(column_values[iRow]), integer_value)) typed[iRow] = integer_value;
+      }
+      wide[iColumn + 1] = typed;
+      break;
+    }
+    case VARIABLE_STRING: {
+      CharacterVector typed(total_rows);
+      for(R_xlen_t iRow = 0; iRow < total_rows; iRow++){
+        typed[iRow] = column_values[iRow];
+      }
+      wide[iColumn + 1] = typed;
+      break;
+    }
+    }
+    wide_names[iColumn + 1] = column_name[iColumn];
+  }
+  wide.attr("names") = wide_names;
+  wide.attr("row.names") = IntegerVector::create(NA_INTEGER, -total_rows);
+  wide.attr("class") = "data.frame";
+  return DataFrame(wide);
+}
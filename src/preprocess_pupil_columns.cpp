@@ -0,0 +1,256 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <map>
+using namespace Rcpp;
+
+// interval of samples that must be discarded
+typedef struct MASKED_INTERVAL {
+  int eye;
+  double sttime;
+  double entime;
+} MASKED_INTERVAL;
+
+// a single pupil column of a single trial, processed without R API
+typedef struct PUPIL_TASK {
+  const double* pupil;
+  double* out;
+  int eye;
+  size_t first_row;
+  size_t rows;
+  const std::vector <MASKED_INTERVAL>* blinks;
+  double anchor;
+} PUPIL_TASK;
+
+// settings shared by all tasks
+typedef struct PUPIL_PIPELINE {
+  const double* time;
+  double pad_before;
+  double pad_after;
+  bool cubic;
+  double max_gap;
+  bool baseline;
+  double baseline_start;
+  double baseline_end;
+  bool divide;
+} PUPIL_PIPELINE;
+
+//' @title Value of a cubic polynomial through four points at x
+//' @param double* xs, abscissas of the points
+//' @param double* ys, ordinates of the points
+//' @param double x
+//' @return double
+//' @keywords internal
+inline double lagrange_cubic(const double* xs, const double* ys, double x){
+  double value = 0;
+  for(int i = 0; i < 4; i++){
+    double weight = 1;
+    for(int j = 0; j < 4; j++) if (j != i) weight *= (x - xs[j]) / (xs[i] - xs[j]);
+    value += weight * ys[i];
+  }
+  return value;
+}
+
+//' @title Runs the pupil pipeline for a single column of a single trial
+//' @description Masks invalid samples and padded blinks, interpolates masked gaps that have
+//' valid samples on both sides, and corrects for the baseline.
+//' @param PUPIL_TASK task
+//' @param PUPIL_PIPELINE pipeline
+//' @keywords internal
+void preprocess_pupil_trial(const PUPIL_TASK &task, const PUPIL_PIPELINE &pipeline){
+  const double* time = pipeline.time + task.first_row;
+  const double* pupil = task.pupil + task.first_row;
+  double* out = task.out + task.first_row;
+  const size_t rows = task.rows;
+
+  // masking missing or non-positive values and padded blinks of the same eye
+  std::vector <bool> valid(rows);
+  for(size_t iRow = 0; iRow < rows; iRow++){
+    valid[iRow] = !ISNAN(pupil[iRow]) && pupil[iRow] > 0;
+    out[iRow] = valid[iRow] ? pupil[iRow] : NA_REAL;
+  }
+  if (task.blinks != NULL){
+    for(size_t iBlink = 0; iBlink < task.blinks->size(); iBlink++){
+      const MASKED_INTERVAL &blink = (*task.blinks)[iBlink];
+      if (blink.eye != task.eye) continue;
+      const double* first = std::lower_bound(time, time + rows, blink.sttime - pipeline.pad_before);
+      const double* last = std::upper_bound(time, time + rows, blink.entime + pipeline.pad_after);
+      for(size_t iRow = first - time; iRow < (size_t)(last - time); iRow++){
+        valid[iRow] = false;
+        out[iRow] = NA_REAL;
+      }
+    }
+  }
+
+  // interpolating gaps between valid samples
+  size_t iRow = 0;
+  while (iRow < rows){
+    if (valid[iRow]){
+      iRow++;
+      continue;
+    }
+    size_t gap_end = iRow;
+    while (gap_end < rows && !valid[gap_end]) gap_end++;
+    if (iRow == 0 || gap_end == rows || time[gap_end] - time[iRow - 1] > pipeline.max_gap){
+      iRow = gap_end;
+      continue;
+    }
+
+    // cubic interpolation uses two extra points as far from the gap as the gap is long
+    const long before = iRow - 1;
+    const long after = gap_end;
+    bool use_cubic = pipeline.cubic;
+    double xs[4], ys[4];
+    if (use_cubic){
+      const double gap_duration = time[after] - time[before];
+      const long outer_before = std::upper_bound(time, time + rows, time[before] - gap_duration) - time - 1;
+      const long outer_after = std::lower_bound(time, time + rows, time[after] + gap_duration) - time;
+      use_cubic = outer_before >= 0 && outer_before < before && outer_after < (long)rows && outer_after > after &&
+        valid[outer_before] && valid[outer_after];
+      if (use_cubic){
+        const long points[4] = {outer_before, before, after, outer_after};
+        for(int iPoint = 0; iPoint < 4; iPoint++){
+          xs[iPoint] = time[points[iPoint]];
+          ys[iPoint] = out[points[iPoint]];
+        }
+      }
+    }
+    for(size_t iGap = iRow; iGap < gap_end; iGap++){
+      if (use_cubic) out[iGap] = lagrange_cubic(xs, ys, time[iGap]);
+      else {
+        const double fraction = (time[iGap] - time[before]) / (time[after] - time[before]);
+        out[iGap] = out[before] + fraction * (out[after] - out[before]);
+      }
+    }
+    iRow = gap_end;
+  }
+
+  // baseline correction relative to the anchor
+  if (!pipeline.baseline) return;
+  double sum = 0;
+  size_t count = 0;
+  if (!ISNAN(task.anchor)){
+    const double* first = std::lower_bound(time, time + rows, task.anchor + pipeline.baseline_start);
+    const double* last = std::upper_bound(time, time + rows, task.anchor + pipeline.baseline_end);
+    for(size_t iBaseline = first - time; iBaseline < (size_t)(last - time); iBaseline++){
+      if (ISNAN(out[iBaseline])) continue;
+      sum += out[iBaseline];
+      count++;
+    }
+  }
+  const double baseline = count > 0 ? sum / count : NA_REAL;
+  for(size_t iRow = 0; iRow < rows; iRow++){
+    if (ISNAN(baseline)) out[iRow] = NA_REAL;
+    else if (!ISNAN(out[iRow])) out[iRow] = pipeline.divide ? out[iRow] / baseline : out[iRow] - baseline;
+  }
+}
+
+//' @title Cleans pupil size samples trial by trial
+//' @description For every pupil column and trial (run of rows with the same \code{trial} value),
+//' samples that are missing, non-positive, or within padded blinks of the same eye are masked.
+//' Masked gaps with valid samples on both sides and not longer than \code{max_gap} are interpolated
+//' either linearly or via a cubic polynomial through two samples on each side of the gap, placed at the gap
+//' edges and as far from them as the gap is long (linear interpolation is used, if these samples are not valid).
+//' Finally, the mean of the cleaned values within the baseline window relative to the trial anchor is
+//' subtracted from (or divides) all values of the trial. Trials and columns are processed in parallel.
+//' Samples must be sorted by time within each trial.
+//' You don't need to call this function directly, as it is used by \code{\link{preprocess_pupil}}.
+//' @param columns List of numeric vectors with pupil size.
+//' @param column_eye Integer vector with eye of each column (\code{0} for left, \code{1} for right).
+//' @param trial Numeric vector with trial index for every sample.
+//' @param time Numeric vector with time of every sample.
+//' @param blink_trial Numeric vector with trial index of blinks.
+//' @param blink_eye Integer vector with eye of blinks (\code{0} for left, \code{1} for right).
+//' @param blink_sttime Numeric vector with onset time of blinks.
+//' @param blink_entime Numeric vector with offset time of blinks.
+//' @param pad_before Time masked before each blink.
+//' @param pad_after Time masked after each blink.
+//' @param cubic Whether to use cubic (\code{TRUE}) or linear (\code{FALSE}) interpolation.
+//' @param max_gap Longest gap (between valid samples) that is interpolated.
+//' @param anchor_trial Numeric vector with trial index of baseline anchors.
+//' @param anchor_time Numeric vector with time of baseline anchors, the first anchor within a trial is used.
+//' @param baseline_start Start of the baseline window relative to the anchor.
+//' @param baseline_end End of the baseline window relative to the anchor.
+//' @param baseline_method 0, no baseline correction. 1, subtraction. 2, division.
+//' @return List of cleaned numeric vectors.
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+List preprocess_pupil_columns(List columns,
+                              IntegerVector column_eye,
+                              NumericVector trial,
+                              NumericVector time,
+                              NumericVector blink_trial,
+                              IntegerVector blink_eye,
+                              NumericVector blink_sttime,
+                              NumericVector blink_entime,
+                              double pad_before,
+                              double pad_after,
+                              bool cubic,
+                              double max_gap,
+                              NumericVector anchor_trial,
+                              NumericVector anchor_time,
+                              double baseline_start,
+                              double baseline_end,
+                              int baseline_method){
+  const size_t rows = trial.size();
+  if ((size_t)time.size() != rows) ::Rf_error("trial and time must have the same length.");
+  if (column_eye.size() != columns.size()) ::Rf_error("column_eye must have an eye for every column.");
+  if (blink_eye.size() != blink_trial.size() || blink_sttime.size() != blink_trial.size() || blink_entime.size() != blink_trial.size()){
+    ::Rf_error("blink_trial, blink_eye, blink_sttime, and blink_entime must have the same length.");
+  }
+  if (anchor_time.size() != anchor_trial.size()) ::Rf_error("anchor_trial and anchor_time must have the same length.");
+  for(size_t iRow = 1; iRow < rows; iRow++){
+    if (trial[iRow] == trial[iRow - 1] && time[iRow] < time[iRow - 1]) ::Rf_error("Samples must be sorted by time within each trial.");
+  }
+
+  // blinks and anchors by trial, NaN is not a valid key of an ordered map
+  std::map <double, std::vector <MASKED_INTERVAL> > blinks;
+  for(R_xlen_t iBlink = 0; iBlink < blink_trial.size(); iBlink++){
+    if (ISNAN(blink_trial[iBlink]) || blink_eye[iBlink] == NA_INTEGER || ISNAN(blink_sttime[iBlink]) || ISNAN(blink_entime[iBlink])) continue;
+    MASKED_INTERVAL blink = {blink_eye[iBlink], blink_sttime[iBlink], blink_entime[iBlink]};
+    blinks[blink_trial[iBlink]].push_back(blink);
+  }
+  std::map <double, double> anchors;
+  for(R_xlen_t iAnchor = 0; iAnchor < anchor_trial.size(); iAnchor++){
+    if (!ISNAN(anchor_trial[iAnchor]) && anchors.count(anchor_trial[iAnchor]) == 0) anchors[anchor_trial[iAnchor]] = anchor_time[iAnchor];
+  }
+
+  PUPIL_PIPELINE pipeline = {time.begin(), pad_before, pad_after, cubic, max_gap,
+                             baseline_method != 0, baseline_start, baseline_end, baseline_method == 2};
+
+  // tasks for every column and trial, columns are kept in a list, so that columns coerced to double
+  // stay protected until the tasks are done
+  List inputs(columns.size());
+  List cleaned(columns.size());
+  std::vector <PUPIL_TASK> tasks;
+  for(R_xlen_t iColumn = 0; iColumn < columns.size(); iColumn++){
+    NumericVector pupil = columns[iColumn];
+    inputs[iColumn] = pupil;
+    if ((size_t)pupil.size() != rows) ::Rf_error("All columns must have the same length as trial.");
+    NumericVector out(rows);
+    cleaned[iColumn] = out;
+
+    size_t first_row = 0;
+    for(size_t iRow = 1; iRow <= rows; iRow++){
+      if (iRow < rows && (trial[iRow] == trial[iRow - 1] || (ISNAN(trial[iRow]) && ISNAN(trial[iRow - 1])))) continue;
+      // samples without a trial have neither blinks nor an anchor
+      const double current_trial = trial[first_row];
+      std::map <double, std::vector <MASKED_INTERVAL> >::const_iterator trial_blinks = ISNAN(current_trial) ? blinks.end() : blinks.find(current_trial);
+      std::map <double, double>::const_iterator trial_anchor = ISNAN(current_trial) ? anchors.end() : anchors.find(current_trial);
+      PUPIL_TASK task = {pupil.begin(), out.begin(), column_eye[iColumn], first_row, iRow - first_row,
+                         trial_blinks == blinks.end() ? NULL : &trial_blinks->second,
+                         trial_anchor == anchors.end() ? NA_REAL : trial_anchor->second};
+      tasks.push_back(task);
+      first_row = iRow;
+    }
+  }
+
+  const int total_tasks = tasks.size();
+  #pragma omp parallel for schedule(dynamic)
+  for(int iTask = 0; iTask < total_tasks; iTask++){
+    preprocess_pupil_trial(tasks[iTask], pipeline);
+  }
+
+  cleaned.attr("names") = columns.attr("names");
+  return cleaned;
+}
@@ -0,0 +1,281 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include "column_codec.h"
+#include "column_store.h"
+using namespace Rcpp;
+
+// encoded block read from the file and the memory it decodes into
+typedef struct LOADED_BLOCK {
+  STORED_BLOCK stored;
+  size_t element_size;
+  std::vector <uint8_t> encoded;
+  uint8_t* destination;
+  std::vector <uint8_t> decoded; // used for strings only
+  bool ok;
+} LOADED_BLOCK;
+
+//' @title Checks whether a chunk may contain any of the requested trials
+//' @param STORED_CHUNK chunk
+//' @param std::vector <double> trials
+//' @return bool
+//' @keywords internal
+bool chunk_contains_trials(const STORED_CHUNK &chunk, const std::vector <double> &trials){
+  if (std::isnan(chunk.min_trial) || std::isnan(chunk.max_trial)) return true;
+  for(size_t iTrial = 0; iTrial < trials.size(); iTrial++){
+    if (trials[iTrial] >= chunk.min_trial && trials[iTrial] <= chunk.max_trial) return true;
+  }
+  return false;
+}
+
+//' @title Reads an encoded block from the file
+//' @param FILE* file
+//' @param STORED_BLOCK block
+//' @param std::vector <uint8_t> encoded
+//' @return bool, whether the block was read
+//' @keywords internal
+bool read_stored_block(FILE* file, const STORED_BLOCK &block, std::vector <uint8_t> &encoded){
+  encoded.resize(block.encoded_size);
+  if (block.encoded_size == 0) return true;
+  if (seek_store_file(file, (int64_t)block.offset, SEEK_SET) != 0) return false;
+  return fread(encoded.data(), 1, block.encoded_size, file) == block.encoded_size;
+}
+
+//' @title Decodes loaded blocks in parallel
+//' @param std::vector <LOADED_BLOCK> blocks
+//' @return bool, whether all blocks were decoded
+//' @keywords internal
+bool decode_loaded_blocks(std::vector <LOADED_BLOCK> &blocks){
+  const int total_blocks = blocks.size();
+  #pragma omp parallel for schedule(dynamic)
+  for(int iBlock = 0; iBlock < total_blocks; iBlock++){
+    LOADED_BLOCK &block = blocks[iBlock];
+    uint8_t* destination = block.destination;
+    if (destination == NULL){
+      block.decoded.resize(block.stored.decoded_size);
+      destination = block.decoded.data();
+    }
+    block.ok = decode_block(block.encoded.data(), block.encoded.size(), block.stored.codec, block.element_size,
+                            destination, block.stored.decoded_size);
+    std::vector <uint8_t>().swap(block.encoded);
+  }
+
+  for(int iBlock = 0; iBlock < total_blocks; iBlock++) if (!blocks[iBlock].ok) return false;
+  return true;
+}
+
+//' @title Converts length-prefixed UTF-8 bytes into strings
+//' @param std::vector <uint8_t> decoded
+//' @param CharacterVector column
+//' @param R_xlen_t first_row
+//' @param R_xlen_t rows
+//' @return bool, whether the block matched the number of rows
+//' @keywords internal
+bool restore_string_chunk(const std::vector <uint8_t> &decoded, CharacterVector column, R_xlen_t first_row, R_xlen_t rows){
+  size_t position = 0;
+  for(R_xlen_t iRow = 0; iRow < rows; iRow++){
+    if (decoded.size() - position < sizeof(int32_t)) return false;
+    int32_t length;
+    memcpy(&length, decoded.data() + position, sizeof(length));
+    position += sizeof(length);
+    if (length < 0){
+      column[first_row + iRow] = NA_STRING;
+      continue;
+    }
+    if (decoded.size() - position < (size_t)length) return false;
+    column[first_row + iRow] = Rf_mkCharLenCE((const char*)decoded.data() + position, length, CE_UTF8);
+    position += length;
+  }
+  return position == decoded.size();
+}
+
+//' @title Reads tables and serialized objects from a column store file
+//' @description Only the directory and blocks of the requested tables, columns, and
+//' chunks are read from the file. Blocks are decoded in parallel directly into R vectors.
+//' When \code{trials} are specified, only chunks that may contain them are read, so
+//' tables can contain rows of other trials that share the same chunk.
+//' You don't need to call this function directly, as it is used by \code{\link{read_recording}}.
+//' @param filename Name of the file.
+//' @param tables Names of tables and objects to read or \code{NULL} for all of them.
+//' @param columns Names of columns to read or \code{NULL} for all of them. The \code{trial}
+//' column is always read, if \code{trials} are specified.
+//' @param trials Trials to read or \code{NULL} for all of them.
+//' @return List with \code{tables} (named list of data.frames) and \code{objects} (named list of raw vectors).
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+List read_column_store(std::string filename, Nullable<CharacterVector> tables, Nullable<CharacterVector> columns, Nullable<NumericVector> trials){
+  // selection
+  const bool all_tables = tables.isNull();
+  const bool all_columns = columns.isNull();
+  const bool all_trials = trials.isNull();
+  std::vector <std::string> selected_tables;
+  std::vector <std::string> selected_columns;
+  std::vector <double> selected_trials;
+  if (!all_tables) selected_tables = as<std::vector <std::string> >(tables.get());
+  if (!all_columns) selected_columns = as<std::vector <std::string> >(columns.get());
+  if (!all_trials) selected_trials = as<std::vector <double> >(trials.get());
+  if (!all_trials) selected_columns.push_back("trial");
+
+  // directory
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (file == NULL){
+    std::stringstream error_message_stream;
+    error_message_stream << "Error opening file '" << filename << "'.";
+    ::Rf_error("%s", error_message_stream.str().c_str());
+  }
+  char magic[COLUMN_STORE_MAGIC_SIZE];
+  uint64_t directory_offset = 0;
+  uint64_t file_size = 0;
+  bool read_ok = fread(magic, 1, COLUMN_STORE_MAGIC_SIZE, file) == COLUMN_STORE_MAGIC_SIZE &&
+    memcmp(magic, COLUMN_STORE_MAGIC, COLUMN_STORE_MAGIC_SIZE) == 0 &&
+    seek_store_file(file, -(int64_t)sizeof(directory_offset), SEEK_END) == 0 &&
+    fread(&directory_offset, sizeof(directory_offset), 1, file) == 1;
+  if (read_ok){
+    const int64_t position = tell_store_file(file);
+    file_size = position < 0 ? 0 : (uint64_t)position;
+    read_ok = position >= 0 && directory_offset >= COLUMN_STORE_MAGIC_SIZE && directory_offset <= file_size - sizeof(directory_offset);
+  }
+  std::vector <uint8_t> directory;
+  std::vector <STORED_TABLE> stored_tables;
+  std::vector <STORED_OBJECT> stored_objects;
+  if (read_ok){
+    directory.resize(file_size - sizeof(directory_offset) - directory_offset);
+    read_ok = seek_store_file(file, (int64_t)directory_offset, SEEK_SET) == 0 &&
+      fread(directory.data(), 1, directory.size(), file) == directory.size() &&
+      parse_directory(directory, stored_tables, stored_objects);
+  }
+  if (!read_ok){
+    fclose(file);
+    std::stringstream error_message_stream;
+    error_message_stream << "File '" << filename << "' is not a valid recording file.";
+    ::Rf_error("%s", error_message_stream.str().c_str());
+  }
+
+  // tables
+  List table_list;
+  std::vector <std::string> table_names;
+  for(size_t iTable = 0; iTable < stored_tables.size(); iTable++){
+    const STORED_TABLE &stored_table = stored_tables[iTable];
+    if (!all_tables && std::find(selected_tables.begin(), selected_tables.end(), stored_table.name) == selected_tables.end()) continue;
+
+    // chunks and their offsets within the loaded table
+    std::vector <size_t> chunk_index;
+    std::vector <R_xlen_t> chunk_first_row;
+    R_xlen_t rows = 0;
+    for(size_t iChunk = 0; iChunk < stored_table.chunks.size(); iChunk++){
+      if (!all_trials && !chunk_contains_trials(stored_table.chunks[iChunk], selected_trials)) continue;
+      chunk_index.push_back(iChunk);
+      chunk_first_row.push_back(rows);
+      rows += stored_table.chunks[iChunk].rows;
+    }
+
+    // allocating columns and reading their blocks
+    List table(0);
+    std::vector <std::string> column_names;
+    std::vector <LOADED_BLOCK> blocks;
+    std::vector <size_t> block_column;
+    std::vector <size_t> block_chunk;
+    for(size_t iColumn = 0; iColumn < stored_table.columns.size() && read_ok; iColumn++){
+      const STORED_COLUMN &stored_column = stored_table.columns[iColumn];
+      if (!all_columns && std::find(selected_columns.begin(), selected_columns.end(), stored_column.name) == selected_columns.end()) continue;
+
+      RObject column;
+      uint8_t* column_data = NULL;
+      switch(stored_column.type){
+      case COLUMN_LOGICAL:
+        column = LogicalVector(rows);
+        column_data = (uint8_t*)LOGICAL(column);
+        break;
+      case COLUMN_INTEGER:
+      case COLUMN_FACTOR:
+        column = IntegerVector(rows);
+        column_data = (uint8_t*)INTEGER(column);
+        break;
+      case COLUMN_DOUBLE:
+        column = NumericVector(rows);
+        column_data = (uint8_t*)REAL(column);
+        break;
+      case COLUMN_STRING:
+        column = CharacterVector(rows);
+        break;
+      default:
+        read_ok = false;
+        continue;
+      }
+      if (stored_column.type == COLUMN_FACTOR){
+        CharacterVector levels(stored_column.levels.size());
+        for(size_t iLevel = 0; iLevel < stored_column.levels.size(); iLevel++){
+          levels[iLevel] = Rf_mkCharLenCE(stored_column.levels[iLevel].data(), stored_column.levels[iLevel].size(), CE_UTF8);
+        }
+        Rf_setAttrib(column, R_LevelsSymbol, levels);
+        Rf_setAttrib(column, R_ClassSymbol, Rf_mkString("factor"));
+      }
+      table.push_back(column);
+      column_names.push_back(stored_column.name);
+
+      const size_t element_size = column_element_size(stored_column.type);
+      for(size_t iChunk = 0; iChunk < chunk_index.size() && read_ok; iChunk++){
+        LOADED_BLOCK block;
+        block.stored = stored_column.blocks[chunk_index[iChunk]];
+        block.element_size = element_size;
+        block.destination = NULL;
+        block.ok = false;
+        if (column_data != NULL){
+          // numeric blocks are decoded directly into the column
+          if (block.stored.decoded_size != stored_table.chunks[chunk_index[iChunk]].rows * element_size) read_ok = false;
+          block.destination = column_data + chunk_first_row[iChunk] * element_size;
+        }
+        read_ok = read_ok && read_stored_block(file, block.stored, block.encoded);
+        blocks.push_back(block);
+        block_column.push_back(table.size() - 1);
+        block_chunk.push_back(iChunk);
+      }
+    }
+
+    // decoding in parallel, strings are converted to R afterwards
+    read_ok = read_ok && decode_loaded_blocks(blocks);
+    for(size_t iBlock = 0; iBlock < blocks.size() && read_ok; iBlock++){
+      if (blocks[iBlock].destination != NULL) continue;
+      const size_t iChunk = block_chunk[iBlock];
+      read_ok = restore_string_chunk(blocks[iBlock].decoded, table[block_column[iBlock]], chunk_first_row[iChunk],
+                                     stored_table.chunks[chunk_index[iChunk]].rows);
+      std::vector <uint8_t>().swap(blocks[iBlock].decoded);
+    }
+    if (!read_ok) break;
+
+    table.attr("names") = wrap(column_names);
+    table.attr("row.names") = IntegerVector::create(NA_INTEGER, -rows);
+    table.attr("class") = "data.frame";
+    table_list.push_back(table);
+    table_names.push_back(stored_table.name);
+  }
+
+  // objects
+  List object_list;
+  std::vector <std::string> object_names;
+  for(size_t iObject = 0; iObject < stored_objects.size() && read_ok; iObject++){
+    const STORED_OBJECT &stored_object = stored_objects[iObject];
+    if (!all_tables && std::find(selected_tables.begin(), selected_tables.end(), stored_object.name) == selected_tables.end()) continue;
+
+    RawVector object(stored_object.block.decoded_size);
+    std::vector <LOADED_BLOCK> blocks(1);
+    blocks[0].stored = stored_object.block;
+    blocks[0].element_size = 1;
+    blocks[0].destination = RAW(object);
+    read_ok = read_stored_block(file, stored_object.block, blocks[0].encoded) && decode_loaded_blocks(blocks);
+    object_list.push_back(object);
+    object_names.push_back(stored_object.name);
+  }
+  fclose(file);
+  if (!read_ok){
+    std::stringstream error_message_stream;
+    error_message_stream << "File '" << filename << "' is corrupted.";
+    ::Rf_error("%s", error_message_stream.str().c_str());
+  }
+
+  table_list.attr("names") = wrap(table_names);
+  object_list.attr("names") = wrap(object_names);
+  return List::create(_["tables"] = table_list, _["objects"] = object_list);
+}
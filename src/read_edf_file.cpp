@@ -4,6 +4,8 @@ using namespace Rcpp;
 
 //' @title Internal function that reads EDF file
 //' @description Reads EDF file into a list that contains events, samples, and recordings.
+//' Trials are decoded on a worker thread, while the calling thread shows progress and checks
+//' for user interrupts (independent of \code{verbose}). An interrupted import returns trials read so far.
 //' DO NOT call this function directly. Instead, use read_edf function that implements
 //' parameter checks and additional postprocessing.
 //' @param filename full name of the EDF file
@@ -13,9 +15,21 @@ using namespace Rcpp;
 //' @param import_events load/skip loading events.
 //' @param import_recordings load/skip loading recordings.
 //' @param import_samples load/skip loading of samples.
+//' @param import_trial_summary whether to compute per-trial and per-eye summary statistics
+//' from samples and events on the fly. Neither samples nor events need to be imported for that.
 //' @param sample_attr_flag boolean vector that indicates which sample fields are to be stored
+//' @param memory_limit maximal size of sample buffers in bytes. Once exceeded, buffers are spilled
+//' to temporary column files and samples are returned as memory-mapped vectors. Inf, no limit.
 //' @param start_marker_string event that marks trial start. Defaults to "TRIALID", if empty.
 //' @param end_marker_string event that marks trial end
+//' @param trial_index trial headers resolved from a message index (see \code{\link{index_trials}}).
+//' If specified, trial navigation of the EDF API is not used. Instead, the file is read sequentially
+//' once and records are assigned to trials by their time. \code{NULL}, use EDF API trial navigation.
+//' @param recording_blocks headers of recording blocks, see \code{\link{resolve_recording_blocks}}.
+//' If specified together with \code{trial_index}, records are read block by block, including those between trials
+//' (trial 0), and samples get \code{block} column. \code{NULL}, read trials.
+//' @param sample_filter filter specification created by \code{\link{sample_filter}}. Listed sample
+//' columns are filtered at the end of every trial, before they are stored (or spilled to disk). \code{NULL}, no filtering.
 //' @param verbose whether to show progressbar and report number of trials
 //' @export
 //' @keywords internal
@@ -26,9 +40,14 @@ List read_edf_file(std::string filename,
                    bool import_events,
                    bool import_recordings,
                    bool import_samples,
+                   bool import_trial_summary,
                    LogicalVector sample_attr_flag,
+                   double memory_limit,
                    std::string start_marker_string,
                    std::string end_marker_string,
+                   Nullable<NumericMatrix> trial_index,
+                   Nullable<NumericMatrix> recording_blocks,
+                   Nullable<List> sample_filter,
                    bool verbose){
   return(List::create());
 }
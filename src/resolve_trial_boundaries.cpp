@@ -0,0 +1,104 @@
+#include <Rcpp.h>
+#include <cstring>
+using namespace Rcpp;
+
+//' @title Checks whether a message starts with a marker
+//' @param SEXP message, CHARSXP
+//' @param std::string marker
+//' @return bool
+//' @keywords internal
+inline bool starts_with_marker(SEXP message, const std::string &marker){
+  if (message == NA_STRING) return false;
+  return strncmp(CHAR(message), marker.c_str(), marker.size()) == 0;
+}
+
+//' @title Resolves trial boundaries from a message index
+//' @description Finds trials defined by start and end markers in a single pass over
+//' messages in the file order, mirroring trial navigation of the EDF API without rescanning the file.
+//' A trial starts with a message that begins with \code{start_marker} (\code{"TRIALID"}, if empty) and
+//' ends with the first message that begins with \code{end_marker} before the next start marker.
+//' For an empty \code{end_marker}, a trial lasts till the next start marker. If there is no end marker
+//' or no next start marker, a trial lasts till the end of the recording it started in (or till the
+//' last message, if it started outside of a recording).
+//' You don't need to call this function directly, as it is used by \code{\link{index_trials}}.
+//' @param message_time Numeric vector with message timestamps in the file order.
+//' @param message Character vector with messages.
+//' @param recording_time Numeric vector with timestamps of recording information events.
+//' @param recording_state Integer vector with recording state: 1 for start and 0 for end.
+//' @param start_marker Start marker.
+//' @param end_marker End marker, may be empty.
+//' @return data.frame with \code{trial}, \code{duration}, \code{starttime}, \code{endtime}, and
+//' \code{recording} (row of the start recording information event that precedes the trial, \code{NA} if none).
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+DataFrame resolve_trial_boundaries(NumericVector message_time, CharacterVector message,
+                                   NumericVector recording_time, IntegerVector recording_state,
+                                   std::string start_marker, std::string end_marker){
+  if (message_time.size() != message.size()) ::Rf_error("message_time and message must have the same length.");
+  if (recording_time.size() != recording_state.size()) ::Rf_error("recording_time and recording_state must have the same length.");
+  if (start_marker.empty()) start_marker = "TRIALID";
+  const bool has_end_marker = !end_marker.empty();
+  const R_xlen_t total_messages = message.size();
+  const R_xlen_t total_recordings = recording_time.size();
+
+  // start markers
+  std::vector <R_xlen_t> start_rows;
+  for(R_xlen_t iMessage = 0; iMessage < total_messages; iMessage++){
+    if (starts_with_marker(message[iMessage], start_marker)) start_rows.push_back(iMessage);
+  }
+
+  std::vector <double> trial, duration, starttime, endtime;
+  std::vector <int> recording;
+  R_xlen_t iRecording = 0;
+  int active_recording = NA_INTEGER;
+  double active_recording_end = NA_REAL;
+  for(size_t iStart = 0; iStart < start_rows.size(); iStart++){
+    const double start = message_time[start_rows[iStart]];
+    const R_xlen_t next_start_row = iStart + 1 < start_rows.size() ? start_rows[iStart + 1] : total_messages;
+
+    // recording that contains the start marker
+    for(; iRecording < total_recordings && recording_time[iRecording] <= start; iRecording++){
+      active_recording = recording_state[iRecording] == 1 ? iRecording + 1 : NA_INTEGER;
+      active_recording_end = NA_REAL;
+    }
+    if (active_recording != NA_INTEGER && ISNAN(active_recording_end)){
+      for(R_xlen_t iEnd = iRecording; iEnd < total_recordings; iEnd++){
+        if (recording_state[iEnd] != 1){
+          active_recording_end = recording_time[iEnd];
+          break;
+        }
+      }
+    }
+
+    // end marker
+    double end = NA_REAL;
+    if (has_end_marker){
+      for(R_xlen_t iMessage = start_rows[iStart] + 1; iMessage < next_start_row; iMessage++){
+        if (starts_with_marker(message[iMessage], end_marker)){
+          end = message_time[iMessage];
+          break;
+        }
+      }
+    }
+    else if (next_start_row < total_messages){
+      end = message_time[next_start_row] - 1;
+    }
+
+    // falling back onto the end of the recording or the last message
+    if (ISNAN(end)) end = !ISNAN(active_recording_end) ? active_recording_end : message_time[next_start_row - 1];
+    if (!has_end_marker && !ISNAN(active_recording_end) && end > active_recording_end) end = active_recording_end;
+
+    trial.push_back(iStart + 1);
+    duration.push_back(end - start);
+    starttime.push_back(start);
+    endtime.push_back(end);
+    recording.push_back(active_recording);
+  }
+
+  return DataFrame::create(_["trial"] = trial,
+                           _["duration"] = duration,
+                           _["starttime"] = starttime,
+                           _["endtime"] = endtime,
+                           _["recording"] = recording);
+}
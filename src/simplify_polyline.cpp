@@ -0,0 +1,102 @@
+#include <Rcpp.h>
+#include <cmath>
+#include <utility>
+using namespace Rcpp;
+
+//' @title Squared distance from a point to a line segment
+//' @param double px, double py, point coordinates
+//' @param double ax, double ay, segment start
+//' @param double bx, double by, segment end
+//' @return double, squared distance
+//' @keywords internal
+double squared_segment_distance(double px, double py, double ax, double ay, double bx, double by){
+  const double dx = bx - ax;
+  const double dy = by - ay;
+  const double length2 = dx * dx + dy * dy;
+  double t = 0;
+  if (length2 > 0) {
+    t = ((px - ax) * dx + (py - ay) * dy) / length2;
+    if (t < 0) t = 0;
+    if (t > 1) t = 1;
+  }
+  const double ex = px - (ax + t * dx);
+  const double ey = py - (ay + t * dy);
+  return ex * ex + ey * ey;
+}
+
+//' @title Marks points of a single polyline kept by Ramer-Douglas-Peucker algorithm
+//' @description Uses an explicit stack instead of recursion, so long polylines cannot overflow the call stack.
+//' @param NumericVector x, NumericVector y, coordinates
+//' @param R_xlen_t first, R_xlen_t last, indexes of polyline ends (inclusive)
+//' @param double tolerance2, squared tolerance
+//' @param LogicalVector keep, flags of kept points
+//' @keywords internal
+void simplify_polyline_range(const NumericVector &x, const NumericVector &y, R_xlen_t first, R_xlen_t last,
+                             double tolerance2, LogicalVector &keep){
+  keep[first] = TRUE;
+  keep[last] = TRUE;
+  std::vector < std::pair <R_xlen_t, R_xlen_t> > ranges;
+  ranges.push_back(std::make_pair(first, last));
+  while (!ranges.empty()){
+    const R_xlen_t start = ranges.back().first;
+    const R_xlen_t end = ranges.back().second;
+    ranges.pop_back();
+
+    double max_distance2 = -1;
+    R_xlen_t farthest = start;
+    for(R_xlen_t iPoint = start + 1; iPoint < end; iPoint++){
+      const double distance2 = squared_segment_distance(x[iPoint], y[iPoint], x[start], y[start], x[end], y[end]);
+      if (distance2 > max_distance2){
+        max_distance2 = distance2;
+        farthest = iPoint;
+      }
+    }
+    if (max_distance2 > tolerance2){
+      keep[farthest] = TRUE;
+      ranges.push_back(std::make_pair(start, farthest));
+      ranges.push_back(std::make_pair(farthest, end));
+    }
+  }
+}
+
+//' @title Simplifies polylines using Ramer-Douglas-Peucker algorithm
+//' @description Drops points that deviate from the simplified polyline by no more than \code{tolerance}.
+//' Consecutive points with the same \code{group} value (e.g., trial) form a single polyline,
+//' missing coordinates break it into separate polylines. Ends of every polyline are always kept.
+//' Used by \code{\link{simplify_samples}}.
+//' @param x Numeric vector with horizontal coordinates.
+//' @param y Numeric vector with vertical coordinates.
+//' @param group Numeric vector with group index, e.g., trial.
+//' @param tolerance Maximal allowed deviation in the units of coordinates, e.g., pixels.
+//' @return Logical vector, whether a point is kept. Points with missing coordinates are never kept.
+//' @export
+//' @keywords internal
+//' @examples
+//' data(gaze)
+//' keep <- simplify_polyline(gaze$samples$gxR, gaze$samples$gyR, gaze$samples$trial, 1)
+//[[Rcpp::export]]
+LogicalVector simplify_polyline(NumericVector x, NumericVector y, NumericVector group, double tolerance){
+  const R_xlen_t total_points = x.size();
+  if (y.size() != total_points || group.size() != total_points) ::Rf_error("x, y, and group must have the same length.");
+  if (!(tolerance >= 0)) ::Rf_error("tolerance must be non-negative.");
+
+  LogicalVector keep(total_points, FALSE);
+  R_xlen_t first = 0;
+  while (first < total_points){
+    if (std::isnan(x[first]) || std::isnan(y[first])){
+      first++;
+      continue;
+    }
+
+    // a polyline lasts while coordinates are valid and the group is the same
+    R_xlen_t last = first;
+    while (last + 1 < total_points &&
+           !std::isnan(x[last + 1]) && !std::isnan(y[last + 1]) &&
+           group[last + 1] == group[first]){
+      last++;
+    }
+    simplify_polyline_range(x, y, first, last, tolerance * tolerance, keep);
+    first = last + 1;
+  }
+  return keep;
+}
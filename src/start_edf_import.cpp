@@ -0,0 +1,43 @@
+#include <Rcpp.h>
+using namespace Rcpp;
+
+
+//' @title Starts import of EDF file on a worker thread
+//' @description Prepares the import on the calling thread and decodes trials on a worker thread,
+//' so that the R session is not blocked. See \code{\link{read_edf_file}} for parameters.
+//' DO NOT call this function directly. Instead, use \code{\link{read_edf_async}} function.
+//' @param filename full name of the EDF file
+//' @param consistency consistency check control, see \code{\link{read_edf_file}}.
+//' @param import_events load/skip loading events.
+//' @param import_recordings load/skip loading recordings.
+//' @param import_samples load/skip loading of samples.
+//' @param import_trial_summary whether to compute per-trial and per-eye summary statistics.
+//' @param sample_attr_flag boolean vector that indicates which sample fields are to be stored
+//' @param memory_limit maximal size of sample buffers in bytes. Inf, no limit.
+//' @param start_marker_string event that marks trial start. Defaults to "TRIALID", if empty.
+//' @param end_marker_string event that marks trial end
+//' @param trial_index trial headers resolved from a message index or \code{NULL}.
+//' @param recording_blocks headers of recording blocks, see \code{\link{resolve_recording_blocks}}.
+//' If specified together with \code{trial_index}, records are read block by block, including those between trials
+//' (trial 0), and samples get \code{block} column. \code{NULL}, read trials.
+//' @param sample_filter filter specification created by \code{\link{sample_filter}} or \code{NULL}.
+//' @export
+//' @keywords internal
+//' @return external pointer to the import, see \code{\link{edf_import_progress}}, \code{\link{cancel_edf_import}},
+//' and \code{\link{collect_edf_import}}.
+//[[Rcpp::export]]
+SEXP start_edf_import(std::string filename,
+                      int consistency,
+                      bool import_events,
+                      bool import_recordings,
+                      bool import_samples,
+                      bool import_trial_summary,
+                      LogicalVector sample_attr_flag,
+                      double memory_limit,
+                      std::string start_marker_string,
+                      std::string end_marker_string,
+                      Nullable<NumericMatrix> trial_index,
+                      Nullable<NumericMatrix> recording_blocks,
+                      Nullable<List> sample_filter){
+  return(R_NilValue);
+}
@@ -0,0 +1,232 @@
+#include <Rcpp.h>
+#include <cmath>
+#include <sstream>
+#include "column_codec.h"
+#include "column_store.h"
+using namespace Rcpp;
+
+// block of raw column data waiting to be encoded
+typedef struct PENDING_BLOCK {
+  const uint8_t* data;
+  size_t size;
+  size_t element_size;
+  std::vector <uint8_t> owned;
+  std::vector <uint8_t> encoded;
+  uint8_t codec;
+} PENDING_BLOCK;
+
+//' @title Splits table rows into chunks that contain whole trials
+//' @description A new chunk starts once the current one has at least \code{chunk_rows} rows
+//' and the trial changes. Tables without a numeric \code{trial} column are split every \code{chunk_rows} rows.
+//' @param DataFrame table
+//' @param R_xlen_t rows, number of rows
+//' @param int chunk_rows, minimal number of rows per chunk
+//' @return std::vector <STORED_CHUNK>
+//' @keywords internal
+std::vector <STORED_CHUNK> split_into_chunks(DataFrame table, R_xlen_t rows, int chunk_rows){
+  std::vector <STORED_CHUNK> chunks;
+  std::vector <double> trial;
+  if (table.containsElementNamed("trial")){
+    SEXP trial_column = table["trial"];
+    if (TYPEOF(trial_column) == REALSXP) trial.assign(REAL(trial_column), REAL(trial_column) + rows);
+    else if (TYPEOF(trial_column) == INTSXP && !Rf_isFactor(trial_column)){
+      for(R_xlen_t iRow = 0; iRow < rows; iRow++) trial.push_back(INTEGER(trial_column)[iRow] == NA_INTEGER ? NAN : INTEGER(trial_column)[iRow]);
+    }
+  }
+  const bool has_trial = !trial.empty();
+
+  STORED_CHUNK chunk = {0, 0, NAN, NAN};
+  for(R_xlen_t iRow = 0; iRow < rows; iRow++){
+    const bool trial_changed = has_trial && iRow > 0 && trial[iRow] != trial[iRow - 1];
+    if (chunk.rows >= (uint64_t)chunk_rows && (!has_trial || trial_changed)){
+      chunks.push_back(chunk);
+      STORED_CHUNK next_chunk = {(uint64_t)iRow, 0, NAN, NAN};
+      chunk = next_chunk;
+    }
+    if (has_trial && !std::isnan(trial[iRow])){
+      if (std::isnan(chunk.min_trial) || trial[iRow] < chunk.min_trial) chunk.min_trial = trial[iRow];
+      if (std::isnan(chunk.max_trial) || trial[iRow] > chunk.max_trial) chunk.max_trial = trial[iRow];
+    }
+    chunk.rows++;
+  }
+  if (chunk.rows > 0 || chunks.empty()) chunks.push_back(chunk);
+  return chunks;
+}
+
+//' @title Serializes strings of a chunk as length-prefixed UTF-8 bytes
+//' @param CharacterVector column
+//' @param STORED_CHUNK chunk
+//' @param std::vector <uint8_t> buffer
+//' @keywords internal
+void store_string_chunk(CharacterVector column, const STORED_CHUNK &chunk, std::vector <uint8_t> &buffer){
+  for(uint64_t iRow = chunk.first_row; iRow < chunk.first_row + chunk.rows; iRow++){
+    SEXP value = column[iRow];
+    if (value == NA_STRING){
+      store_value <int32_t>(buffer, -1);
+      continue;
+    }
+    const char* text = Rf_translateCharUTF8(value);
+    const size_t length = strlen(text);
+    store_value <int32_t>(buffer, (int32_t)length);
+    buffer.insert(buffer.end(), text, text + length);
+  }
+}
+
+//' @title Encodes blocks in parallel
+//' @param std::vector <PENDING_BLOCK> blocks
+//' @keywords internal
+void encode_pending_blocks(std::vector <PENDING_BLOCK> &blocks){
+  const int total_blocks = blocks.size();
+  #pragma omp parallel for schedule(dynamic)
+  for(int iBlock = 0; iBlock < total_blocks; iBlock++){
+    PENDING_BLOCK &block = blocks[iBlock];
+    const uint8_t* data = block.owned.empty() ? block.data : block.owned.data();
+    block.codec = encode_block(data, block.size, block.element_size, block.encoded);
+  }
+}
+
+//' @title Writes encoded blocks to the file and records their location
+//' @param FILE* file
+//' @param std::vector <PENDING_BLOCK> blocks
+//' @param uint64_t offset, current offset within the file
+//' @param std::vector <STORED_BLOCK> stored, locations of blocks
+//' @return bool, whether all blocks were written
+//' @keywords internal
+bool write_pending_blocks(FILE* file, std::vector <PENDING_BLOCK> &blocks, uint64_t &offset, std::vector <STORED_BLOCK> &stored){
+  for(size_t iBlock = 0; iBlock < blocks.size(); iBlock++){
+    STORED_BLOCK block = {offset, blocks[iBlock].encoded.size(), blocks[iBlock].size, blocks[iBlock].codec};
+    if (!blocks[iBlock].encoded.empty() && fwrite(blocks[iBlock].encoded.data(), 1, blocks[iBlock].encoded.size(), file) != blocks[iBlock].encoded.size()) return false;
+    offset += blocks[iBlock].encoded.size();
+    stored.push_back(block);
+
+    // releasing memory as soon as possible
+    std::vector <uint8_t>().swap(blocks[iBlock].encoded);
+    std::vector <uint8_t>().swap(blocks[iBlock].owned);
+  }
+  return true;
+}
+
+//' @title Writes tables and serialized objects into a column store file
+//' @description Each column of each table is split into trial-aligned chunks and every chunk is
+//' byte-shuffled and compressed with an LZ4 block codec. Blocks of a table are encoded in parallel.
+//' You don't need to call this function directly, as it is used by \code{\link{write_recording}}.
+//' @param filename Name of the file.
+//' @param tables Named list of data.frames. Supported column types are logical, integer, double, character, and factor.
+//' @param objects Named list of raw vectors, e.g., objects serialized via \code{serialize()}.
+//' @param chunk_rows Minimal number of rows per chunk.
+//' @return Size of the file in bytes.
+//' @export
+//' @keywords internal
+//[[Rcpp::export]]
+double write_column_store(std::string filename, List tables, List objects, int chunk_rows){
+  if (chunk_rows < 1) ::Rf_error("chunk_rows must be positive.");
+  CharacterVector table_names = tables.size() > 0 ? as<CharacterVector>(tables.names()) : CharacterVector(0);
+  CharacterVector object_names = objects.size() > 0 ? as<CharacterVector>(objects.names()) : CharacterVector(0);
+
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (file == NULL){
+    std::stringstream error_message_stream;
+    error_message_stream << "Error opening file '" << filename << "' for writing.";
+    ::Rf_error("%s", error_message_stream.str().c_str());
+  }
+  bool write_ok = fwrite(COLUMN_STORE_MAGIC, 1, COLUMN_STORE_MAGIC_SIZE, file) == COLUMN_STORE_MAGIC_SIZE;
+  uint64_t offset = COLUMN_STORE_MAGIC_SIZE;
+
+  std::vector <STORED_TABLE> stored_tables;
+  for(R_xlen_t iTable = 0; iTable < tables.size() && write_ok; iTable++){
+    DataFrame table = tables[iTable];
+    STORED_TABLE stored_table;
+    stored_table.name = as<std::string>(table_names[iTable]);
+    stored_table.rows = table.nrows();
+    stored_table.chunks = split_into_chunks(table, table.nrows(), chunk_rows);
+    CharacterVector column_names = table.names();
+
+    // preparing raw data for all blocks of the table, R API is used only here
+    std::vector <PENDING_BLOCK> blocks;
+    for(R_xlen_t iColumn = 0; iColumn < table.size(); iColumn++){
+      SEXP column = table[iColumn];
+      STORED_COLUMN stored_column;
+      stored_column.name = as<std::string>(column_names[iColumn]);
+      if (Rf_isFactor(column)){
+        stored_column.type = COLUMN_FACTOR;
+        CharacterVector levels = Rf_getAttrib(column, R_LevelsSymbol);
+        for(R_xlen_t iLevel = 0; iLevel < levels.size(); iLevel++) stored_column.levels.push_back(Rf_translateCharUTF8(levels[iLevel]));
+      }
+      else if (TYPEOF(column) == LGLSXP) stored_column.type = COLUMN_LOGICAL;
+      else if (TYPEOF(column) == INTSXP) stored_column.type = COLUMN_INTEGER;
+      else if (TYPEOF(column) == REALSXP) stored_column.type = COLUMN_DOUBLE;
+      else if (TYPEOF(column) == STRSXP) stored_column.type = COLUMN_STRING;
+      else {
+        fclose(file);
+        std::stringstream error_message_stream;
+        error_message_stream << "Column '" << stored_column.name << "' of table '" << stored_table.name << "' has unsupported type.";
+        ::Rf_error("%s", error_message_stream.str().c_str());
+      }
+
+      const size_t element_size = column_element_size(stored_column.type);
+      for(size_t iChunk = 0; iChunk < stored_table.chunks.size(); iChunk++){
+        const STORED_CHUNK &chunk = stored_table.chunks[iChunk];
+        PENDING_BLOCK block;
+        block.element_size = element_size;
+        block.data = NULL;
+        if (stored_column.type == COLUMN_STRING){
+          store_string_chunk(column, chunk, block.owned);
+          block.size = block.owned.size();
+        }
+        else {
+          const uint8_t* column_data = stored_column.type == COLUMN_DOUBLE ? (const uint8_t*)REAL(column) :
+            (stored_column.type == COLUMN_LOGICAL ? (const uint8_t*)LOGICAL(column) : (const uint8_t*)INTEGER(column));
+          block.data = column_data + chunk.first_row * element_size;
+          block.size = chunk.rows * element_size;
+        }
+        blocks.push_back(block);
+      }
+      stored_table.columns.push_back(stored_column);
+    }
+
+    // encoding all blocks of the table in parallel, blocks are ordered by column and then by chunk
+    encode_pending_blocks(blocks);
+    std::vector <STORED_BLOCK> stored_blocks;
+    write_ok = write_pending_blocks(file, blocks, offset, stored_blocks);
+    const size_t total_chunks = stored_table.chunks.size();
+    for(size_t iColumn = 0; iColumn < stored_table.columns.size() && write_ok; iColumn++){
+      stored_table.columns[iColumn].blocks.assign(stored_blocks.begin() + iColumn * total_chunks,
+                                                  stored_blocks.begin() + (iColumn + 1) * total_chunks);
+    }
+    stored_tables.push_back(stored_table);
+  }
+
+  // serialized objects are encoded as single blocks
+  std::vector <STORED_OBJECT> stored_objects;
+  std::vector <PENDING_BLOCK> object_blocks;
+  for(R_xlen_t iObject = 0; iObject < objects.size(); iObject++){
+    RawVector object = objects[iObject];
+    PENDING_BLOCK block;
+    block.data = RAW(object);
+    block.size = object.size();
+    block.element_size = 1;
+    object_blocks.push_back(block);
+  }
+  encode_pending_blocks(object_blocks);
+  std::vector <STORED_BLOCK> stored_object_blocks;
+  if (write_ok) write_ok = write_pending_blocks(file, object_blocks, offset, stored_object_blocks);
+  for(R_xlen_t iObject = 0; iObject < objects.size() && write_ok; iObject++){
+    STORED_OBJECT object = {as<std::string>(object_names[iObject]), stored_object_blocks[iObject]};
+    stored_objects.push_back(object);
+  }
+
+  // directory and its offset
+  if (write_ok){
+    std::vector <uint8_t> directory = store_directory(stored_tables, stored_objects);
+    write_ok = fwrite(directory.data(), 1, directory.size(), file) == directory.size() &&
+      fwrite(&offset, sizeof(offset), 1, file) == 1;
+    offset += directory.size() + sizeof(offset);
+  }
+  write_ok = (fclose(file) == 0) && write_ok;
+  if (!write_ok){
+    std::stringstream error_message_stream;
+    error_message_stream << "Error writing file '" << filename << "'.";
+    ::Rf_error("%s", error_message_stream.str().c_str());
+  }
+  return (double)offset;
+}